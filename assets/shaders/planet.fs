@@ -0,0 +1,112 @@
+#version 330
+
+// Planet layers on the GPU, one fragment per pixel. Mirrors
+// generatePlanetLand and generatePlanetAtmosphere in planetGen.c (noise from
+// noise.c, shading from pixel.c) step for step, so the two backends agree up
+// to float rounding. Rows are written in image order: row y of the image is
+// framebuffer row y, which is how raylib uploads images too.
+
+out vec4 finalColor;
+
+uniform int mode;           // 0 land, 1 atmosphere
+uniform int res;
+uniform ivec2 shadowCentre;
+uniform vec4 atmColor;      // 0-255 per channel
+uniform sampler2D lut;      // 256x1 baked colour ramp, see rampLUT
+uniform int octaves;
+uniform int seeds1[8];      // per octave lattice seeds of each noise layer
+uniform int seeds2[8];
+uniform float step1;        // frequency / res of each noise layer
+uniform float step2;
+
+const float gradX[8] = float[8](1.0, -1.0, 1.0, -1.0, 1.0, -1.0, 0.0, 0.0);
+const float gradY[8] = float[8](1.0, 1.0, -1.0, -1.0, 0.0, 0.0, 1.0, -1.0);
+
+uint hash2(int x, int y, uint seed) {
+    uint h = seed ^ (uint(x) * 0x8da6b343u) ^ (uint(y) * 0xd8163841u);
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    h *= 0x846ca68bu;
+    h ^= h >> 16;
+    return h;
+}
+
+float fade(float t) { return t * t * t * (t * (t * 6.0 - 15.0) + 10.0); }
+
+float lerp(float a, float b, float t) { return a + t * (b - a); }
+
+float corner(int ix, int iy, uint seed, float dx, float dy) {
+    uint h = hash2(ix, iy, seed) & 7u;
+    return gradX[h] * dx + gradY[h] * dy;
+}
+
+float perlin2(float x, float y, uint seed) {
+    float fx = floor(x);
+    float fy = floor(y);
+    int ix = int(fx);
+    int iy = int(fy);
+    float dx = x - fx;
+    float dy = y - fy;
+
+    float n00 = corner(ix, iy, seed, dx, dy);
+    float n10 = corner(ix + 1, iy, seed, dx - 1.0, dy);
+    float n01 = corner(ix, iy + 1, seed, dx, dy - 1.0);
+    float n11 = corner(ix + 1, iy + 1, seed, dx - 1.0, dy - 1.0);
+
+    float u = fade(dx);
+    return lerp(lerp(n00, n10, u), lerp(n01, n11, u), fade(dy));
+}
+
+// noiseFieldU8 of a perlin layer: lacunarity 2, gain 0.5, clamped and remapped
+int perlinField(ivec2 p, float stepSize, bool second) {
+    float fx = float(p.x) * stepSize;
+    float fy = float(p.y) * stepSize;
+    float sum = 0.0;
+    float amp = 1.0;
+    float freq = 1.0;
+
+    for (int o = 0; o < octaves; o++) {
+        uint seed = uint(second ? seeds2[o] : seeds1[o]);
+        sum += perlin2(fx * freq, fy * freq, seed) * amp;
+        freq *= 2.0;
+        amp *= 0.5;
+    }
+
+    sum = clamp(sum, -1.0, 1.0);
+    return int((sum + 1.0) / 2.0 * 255.0);
+}
+
+bool inCircle(ivec2 p, int circle) {
+    vec2 d = vec2(p - ivec2(circle));
+    return sqrt(dot(d, d)) < float(circle);
+}
+
+float shadowFactor(ivec2 p) {
+    vec2 d = vec2(p - shadowCentre);
+    int dist = int(sqrt(dot(d, d)) / 1.05);
+    return max(1.0 - float(dist) / (float(res) / 2.0), 0.0);
+}
+
+vec4 darken(ivec4 c, float f) {
+    return vec4(ivec3(vec3(c.rgb) * f), c.a);
+}
+
+void main() {
+    ivec2 p = ivec2(gl_FragCoord.xy);
+
+    if (!inCircle(p, res / 2)) {
+        finalColor = vec4(0.0);
+        return;
+    }
+
+    ivec4 c;
+    if (mode == 0) {
+        int n = (perlinField(p, step1, false) + perlinField(p, step2, true)) / 2;
+        c = ivec4(round(texelFetch(lut, ivec2(n, 0), 0) * 255.0));
+    } else {
+        c = ivec4(atmColor);
+    }
+
+    finalColor = darken(c, shadowFactor(p)) / 255.0;
+}
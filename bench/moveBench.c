@@ -0,0 +1,150 @@
+#include "defs.h"
+#include "integrate.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// Headless microbenchmark for the Move integration kernel. Integrates --count
+// entities (1M by default) laid out as flecs stores the columns, once per
+// frame, and reports per-frame times. Each variant is also checked against a
+// plain scalar loop, and the velocity step against the target below, scaled to
+// --count. Run it pinned to one core (taskset -c 0) for the single core figure.
+//
+// usage: move-bench [--count N] [--frames F]
+
+#define MOVE_BENCH_DT (1.0f / 120)
+#define MOVE_BENCH_TOLERANCE 1e-4
+#define MOVE_BENCH_TARGET_MS 1.0 // median velocity step for 1M entities
+
+typedef struct {
+    usize count;
+    usize frames;
+} BenchArgs;
+
+static f64 nowMs(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e3 + t.tv_nsec / 1e6;
+}
+
+static i32 compareF64(const void* a, const void* b) {
+    f64 x = *(const f64*)a;
+    f64 y = *(const f64*)b;
+    return (x > y) - (x < y);
+}
+
+static BenchArgs parseArgs(i32 argc, char** argv) {
+    BenchArgs a = {.count = 1000000, .frames = 200};
+
+    for (i32 i = 1; i < argc; i += 2) {
+        if (i + 1 == argc) {
+            fprintf(stderr, "missing value for %s\n", argv[i]);
+            exit(1);
+        } else if (!strcmp(argv[i], "--count")) {
+            a.count = strtoull(argv[i + 1], NULL, 10);
+        } else if (!strcmp(argv[i], "--frames")) {
+            a.frames = strtoull(argv[i + 1], NULL, 10);
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            exit(1);
+        }
+    }
+
+    a.count = MAX(a.count, 1);
+    a.frames = MAX(a.frames, 1);
+    return a;
+}
+
+static f32* column(usize count, f32 scale, u32 seed) {
+    f32* c = malloc(sizeof(f32) * count);
+    for (usize i = 0; i < count; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        c[i] = (seed >> 8) / (f32)(1 << 24) * scale;
+    }
+    return c;
+}
+
+static void scalarStep(f32* pos, f32* vel, const f32* accel, const f32* drag,
+                       usize count, f32 dt) {
+    for (usize e = 0; e < count; e++) {
+        for (usize k = 0; k < 2; k++) {
+            f32 v = vel[e * 2 + k];
+            if (accel != NULL) v += accel[e * 2 + k] * dt;
+            if (drag != NULL) v *= 1.0f / (1.0f + drag[e] * dt);
+            vel[e * 2 + k] = v;
+            pos[e * 2 + k] += v * dt;
+        }
+    }
+}
+
+// runs one variant and stores its median step in median, returns false if it
+// disagrees with the scalar loop
+static bool benchVariant(const char* name, const BenchArgs* a, bool withAccel,
+                         bool withDrag, f64* median) {
+    const usize n = a->count;
+    f32* pos = column(n * 2, 1000, 1);
+    f32* vel = column(n * 2, 100, 2);
+    f32* accel = withAccel ? column(n * 2, 10, 3) : NULL;
+    f32* drag = withDrag ? column(n, 2, 4) : NULL;
+    f64* ms = malloc(sizeof(f64) * a->frames);
+
+    for (usize f = 0; f < a->frames; f++) {
+        f64 t0 = nowMs();
+        integrate(pos, vel, accel, drag, n, MOVE_BENCH_DT);
+        ms[f] = nowMs() - t0;
+    }
+
+    // a few more steps from the current state, compared with the scalar loop
+    f32* refPos = malloc(sizeof(f32) * n * 2);
+    f32* refVel = malloc(sizeof(f32) * n * 2);
+    memcpy(refPos, pos, sizeof(f32) * n * 2);
+    memcpy(refVel, vel, sizeof(f32) * n * 2);
+    for (i32 s = 0; s < 4; s++) {
+        integrate(pos, vel, accel, drag, n, MOVE_BENCH_DT);
+        scalarStep(refPos, refVel, accel, drag, n, MOVE_BENCH_DT);
+    }
+
+    f64 err = 0;
+    for (usize i = 0; i < n * 2; i++) {
+        err = fmax(err, fabs(pos[i] - refPos[i]) / fmax(1, fabs(refPos[i])));
+    }
+
+    qsort(ms, a->frames, sizeof(f64), compareF64);
+    *median = ms[a->frames / 2];
+    usize p99 = MIN(a->frames - 1, (usize)(a->frames * 0.99));
+    printf("%-18s %10.3f %10.3f %10.3f %12.2f %10.1e\n", name, ms[0],
+           ms[a->frames / 2], ms[p99], n / ms[a->frames / 2] / 1e3, err);
+
+    free(pos);
+    free(vel);
+    free(accel);
+    free(drag);
+    free(ms);
+    free(refPos);
+    free(refVel);
+    return err <= MOVE_BENCH_TOLERANCE;
+}
+
+int main(i32 argc, char** argv) {
+    BenchArgs a = parseArgs(argc, argv);
+    printf("move-bench: count %zu, frames %zu, %d floats per vector\n\n", a.count,
+           a.frames, INTEGRATE_LANES);
+    printf("%-18s %10s %10s %10s %12s %10s\n", "variant (ms)", "min", "median",
+           "p99", "M ent/s", "rel err");
+
+    f64 velocity, median;
+    bool ok = benchVariant("velocity", &a, false, false, &velocity);
+    ok &= benchVariant("+ acceleration", &a, true, false, &median);
+    ok &= benchVariant("+ accel and drag", &a, true, true, &median);
+
+    f64 target = MOVE_BENCH_TARGET_MS * a.count / 1e6;
+    printf("\ntarget: velocity median under %.3f ms, %s (%.3f ms)\n", target,
+           velocity < target ? "met" : "missed", velocity);
+
+    if (!ok) {
+        fprintf(stderr, "kernel disagrees with the scalar loop\n");
+        return 1;
+    }
+    return 0;
+}
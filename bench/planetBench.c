@@ -0,0 +1,184 @@
+#include "defs.h"
+#include "jobs.h"
+#include "planetGen.h"
+#include <stdio.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+
+// Headless driver for the planet generation pipeline. Needs no window or GPU:
+// everything it calls lives in planetGen.c, pixel.c, noise.c and jobs.c, plus
+// profiler.c for the scopes inside them. planet-compare checks the GPU backend.
+//
+// usage: planet-bench [--count N] [--seed S] [--res R] [--threads T]
+
+typedef struct {
+    const char* name;
+    f64* samples;
+    usize len;
+} Stage;
+
+typedef struct {
+    usize count;
+    u64 seed;
+    i32 res;
+    i32 threads;
+} BenchArgs;
+
+static f64 nowMs(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e3 + t.tv_nsec / 1e6;
+}
+
+static i32 compareF64(const void* a, const void* b) {
+    f64 x = *(const f64*)a;
+    f64 y = *(const f64*)b;
+    return (x > y) - (x < y);
+}
+
+static Stage stageNew(const char* name, usize count) {
+    return (Stage){name, malloc(sizeof(f64) * count), 0};
+}
+
+static void stageReport(Stage* s) {
+    qsort(s->samples, s->len, sizeof(f64), compareF64);
+    usize p99 = MIN(s->len - 1, (usize)(s->len * 0.99));
+    printf("%-26s %10.3f %10.3f %10.3f\n", s->name, s->samples[0],
+           s->samples[s->len / 2], s->samples[p99]);
+    free(s->samples);
+}
+
+#define TIME_STAGE(stage, ...)                                                   \
+    do {                                                                         \
+        f64 t0_ = nowMs();                                                       \
+        __VA_ARGS__;                                                             \
+        (stage).samples[(stage).len++] = nowMs() - t0_;                          \
+    } while (0)
+
+static BenchArgs parseArgs(i32 argc, char** argv) {
+    BenchArgs a = {.count = 20, .seed = 1, .res = PLANET_RES, .threads = 0};
+
+    for (i32 i = 1; i < argc; i += 2) {
+        if (i + 1 == argc) {
+            fprintf(stderr, "missing value for %s\n", argv[i]);
+            exit(1);
+        } else if (!strcmp(argv[i], "--count")) {
+            a.count = strtoull(argv[i + 1], NULL, 10);
+        } else if (!strcmp(argv[i], "--seed")) {
+            a.seed = strtoull(argv[i + 1], NULL, 0);
+        } else if (!strcmp(argv[i], "--res")) {
+            a.res = atoi(argv[i + 1]);
+        } else if (!strcmp(argv[i], "--threads")) {
+            a.threads = atoi(argv[i + 1]);
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            exit(1);
+        }
+    }
+
+    a.count = MAX(a.count, 1);
+    a.res = MAX(a.res, 8);
+    return a;
+}
+
+static void benchStages(const BenchArgs* a) {
+    enum { HARMONIZE, PERLIN_S, CELLULAR_S, DITHER, CROP, AVERAGE, LAND, ATMOS,
+           BACKGROUND, PLANET, STAGE_COUNT };
+    const char* names[STAGE_COUNT] = {
+        "generateHarmonizedColors", "colorPerlin (perlin)", "colorPerlin (cellular)",
+        "dither",                   "cropToCircle",         "averageImages",
+        "generatePlanetLand",       "generatePlanetAtmosphere",
+        "generatePlanetBackground", "generatePlanetImages"};
+
+    Stage stages[STAGE_COUNT];
+    for (i32 i = 0; i < STAGE_COUNT; i++) {
+        stages[i] = stageNew(names[i], a->count);
+    }
+
+    Rng rng = rngInit(a->seed);
+    f64 planetsMs = 0;
+
+    for (usize n = 0; n < a->count; n++) {
+        Color* cls;
+        TIME_STAGE(stages[HARMONIZE],
+                   cls = generateHarmonizedColors(getRandomColor(&rng), 6, 25, 1, 1));
+        ColorRamp ramp = createColorRampAuto(cls, 6, 255);
+        free(cls);
+
+        Image perlin, cellular, shadow, crop, avg, land, atm, bg;
+        TIME_STAGE(stages[PERLIN_S],
+                   perlin = colorPerlin(PERLIN, a->res, ramp, -1, rngNext(&rng)));
+        TIME_STAGE(stages[CELLULAR_S],
+                   cellular = colorPerlin(CELLULAR, a->res, ramp, -1, rngNext(&rng)));
+        TIME_STAGE(stages[DITHER], shadow = dither(0, -a->res / 8, perlin));
+        TIME_STAGE(stages[CROP], crop = cropToCircle(shadow));
+        TIME_STAGE(stages[AVERAGE], avg = averageImages(perlin, cellular));
+        TIME_STAGE(stages[LAND], land = generatePlanetLand(a->res, ramp, 0,
+                                                           -a->res / 8, rngNext(&rng)));
+        TIME_STAGE(stages[ATMOS], atm = generatePlanetAtmosphere(
+                                      a->res * ATMOSPHERE_SCALE, WHITE, 0, -a->res / 8));
+        TIME_STAGE(stages[BACKGROUND],
+                   bg = generatePlanetBackground(ramp, rngNext(&rng)));
+
+        PlanetImages imgs;
+        TIME_STAGE(stages[PLANET], generatePlanetImages(&imgs, rngNext(&rng)));
+        planetsMs += stages[PLANET].samples[stages[PLANET].len - 1];
+
+        Image all[] = {perlin, cellular, shadow, crop, avg, land, atm, bg};
+        for (usize i = 0; i < sizeof(all) / sizeof(all[0]); i++) {
+            UnloadImage(all[i]);
+        }
+        unloadPlanetImages(&imgs);
+    }
+
+    printf("%-26s %10s %10s %10s\n", "stage (ms)", "min", "median", "p99");
+    for (i32 i = 0; i < STAGE_COUNT; i++) {
+        stageReport(&stages[i]);
+    }
+    printf("\nserial:   %8.2f planets/s\n", a->count / (planetsMs / 1e3));
+}
+
+static void planetJob(void* arg) {
+    PlanetImages* imgs = arg;
+    generatePlanetImages(imgs, imgs->seed);
+}
+
+static void benchParallel(const BenchArgs* a) {
+    PlanetImages* imgs = malloc(sizeof(PlanetImages) * a->count);
+    Rng rng = rngInit(a->seed ^ 0x5eed);
+
+    jobsInit(a->threads);
+    f64 t0 = nowMs();
+    for (usize i = 0; i < a->count; i++) {
+        imgs[i].seed = rngNext(&rng);
+        jobsSubmit(planetJob, &imgs[i]);
+    }
+    jobsWait();
+    f64 elapsed = nowMs() - t0;
+
+    printf("parallel: %8.2f planets/s (%d threads)\n", a->count / (elapsed / 1e3),
+           jobsThreadCount());
+
+    for (usize i = 0; i < a->count; i++) {
+        unloadPlanetImages(&imgs[i]);
+    }
+    free(imgs);
+    jobsShutdown();
+}
+
+int main(i32 argc, char** argv) {
+    BenchArgs a = parseArgs(argc, argv);
+    printf("planet-bench: count %zu, seed %llu, res %d\n\n", a.count,
+           (unsigned long long)a.seed, a.res);
+
+    loadPlanetNames();
+
+    benchStages(&a);
+    benchParallel(&a);
+
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    printf("peak rss: %.1f MB\n", ru.ru_maxrss / 1024.0);
+    return 0;
+}
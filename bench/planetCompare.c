@@ -0,0 +1,137 @@
+#include "defs.h"
+#include "planetBackend.h"
+#include "planetGen.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// Checks planets from the GPU backend against the CPU one, in a hidden window.
+// Without a usable GPU it reports the skip and exits 0, so CPU-only machines
+// still pass. Unlike planet-bench this needs GL to link and run.
+//
+// usage: planet-compare [--count N] [--seed S] [--res R]
+
+typedef struct {
+    usize count;
+    u64 seed;
+    i32 res;
+} CompareArgs;
+
+static f64 nowMs(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e3 + t.tv_nsec / 1e6;
+}
+
+static CompareArgs parseArgs(i32 argc, char** argv) {
+    CompareArgs a = {.count = 20, .seed = 1, .res = PLANET_RES};
+
+    for (i32 i = 1; i < argc; i += 2) {
+        if (i + 1 == argc) {
+            fprintf(stderr, "missing value for %s\n", argv[i]);
+            exit(1);
+        } else if (!strcmp(argv[i], "--count")) {
+            a.count = strtoull(argv[i + 1], NULL, 10);
+        } else if (!strcmp(argv[i], "--seed")) {
+            a.seed = strtoull(argv[i + 1], NULL, 0);
+        } else if (!strcmp(argv[i], "--res")) {
+            a.res = atoi(argv[i + 1]);
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            exit(1);
+        }
+    }
+
+    a.count = MAX(a.count, 1);
+    a.res = MAX(a.res, 8);
+    return a;
+}
+
+typedef struct {
+    usize pixels;
+    usize mismatched; // pixels with a channel off by more than the tolerance
+    i32 worst;
+} LayerDiff;
+
+static void diffLayer(LayerDiff* diff, Image a, Image b) {
+    const u8* pa = a.data;
+    const u8* pb = b.data;
+
+    for (i32 i = 0; i < a.width * a.height; i++) {
+        i32 worst = 0;
+        for (i32 c = 0; c < 4; c++) {
+            worst = MAX(worst, abs(pa[i * 4 + c] - pb[i * 4 + c]));
+        }
+        diff->worst = MAX(diff->worst, worst);
+        diff->mismatched += worst > PLANET_BACKEND_TOLERANCE;
+    }
+    diff->pixels += a.width * a.height;
+}
+
+static bool reportDiff(const char* layer, const LayerDiff* d) {
+    f64 share = (f64)d->mismatched / MAX(d->pixels, 1);
+    bool pass = share <= PLANET_BACKEND_MAX_MISMATCH;
+    printf("%-12s %8zu of %8zu pixels differ (%.4f%%), worst channel %3d  %s\n",
+           layer, d->mismatched, d->pixels, share * 100, d->worst,
+           pass ? "ok" : "FAIL");
+    return pass;
+}
+
+// generates the same planets with both backends; non-zero exit on a mismatch
+static i32 compareBackends(const CompareArgs* a) {
+    SetTraceLogLevel(LOG_WARNING);
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    InitWindow(64, 64, "planet-compare");
+
+    if (!IsWindowReady() || !planetBackendGPU.init()) {
+        printf("gpu backend unavailable, skipping the comparison\n");
+        if (IsWindowReady()) CloseWindow();
+        return 0;
+    }
+
+    Rng rng = rngInit(a->seed);
+    LayerDiff land = {0}, atmosphere = {0};
+    f64 cpuMs = 0, gpuMs = 0;
+
+    for (usize n = 0; n < a->count; n++) {
+        PlanetImages imgs;
+        describePlanet(&imgs, rngNext(&rng));
+        imgs.layers.res = a->res;
+        imgs.layers.shadowOffsety = -a->res / 8;
+
+        Image cl, ca, gl, ga;
+        f64 t0 = nowMs();
+        planetBackendCPU.images(&imgs.layers, &cl, &ca);
+        f64 t1 = nowMs();
+        planetBackendGPU.images(&imgs.layers, &gl, &ga);
+        f64 t2 = nowMs();
+        cpuMs += t1 - t0;
+        gpuMs += t2 - t1;
+
+        diffLayer(&land, cl, gl);
+        diffLayer(&atmosphere, ca, ga);
+
+        Image all[] = {cl, ca, gl, ga};
+        for (usize i = 0; i < sizeof(all) / sizeof(all[0]); i++) {
+            UnloadImage(all[i]);
+        }
+    }
+
+    bool pass = reportDiff("land", &land);
+    pass = reportDiff("atmosphere", &atmosphere) && pass;
+    printf("\ncpu: %8.3f ms/planet, gpu (with readback): %8.3f ms/planet\n",
+           cpuMs / a->count, gpuMs / a->count);
+
+    planetBackendGPU.shutdown();
+    CloseWindow();
+    return pass ? 0 : 1;
+}
+
+int main(i32 argc, char** argv) {
+    CompareArgs a = parseArgs(argc, argv);
+    printf("planet-compare: count %zu, seed %llu, res %d\n\n", a.count,
+           (unsigned long long)a.seed, a.res);
+
+    loadPlanetNames();
+    return compareBackends(&a);
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "defs.h"
+#include "flecs.h"
+
+// Horizontal carousel of child entities. The scroll offset follows the target
+// index with a critically damped spring, stepped exactly so it behaves the same
+// at any frame rate. Carousels are only animated while _carouselAwake is set,
+// and children further than one slot from the view are disabled, so they are
+// neither rendered nor updated.
+
+#define CAROUSEL_OMEGA 10      // spring frequency; 95% of the way in 0.5 s
+#define CAROUSEL_EPSILON 1e-3  // in slots; closer than this counts as settled
+#define CAROUSEL_VISIBLE 1.5   // children within this many slots stay enabled
+
+extern ECS_COMPONENT_DECLARE(Carousel);
+extern ECS_COMPONENT_DECLARE(CarouselItem);
+extern ECS_TAG_DECLARE(_carouselAwake);
+extern ECS_SYSTEM_DECLARE(AnimateCarousels);
+
+typedef struct {
+    i32 index;      // target slot
+    i32 count;      // children added so far
+    f32 offset;     // current scroll position, in slots
+    f32 velocity;   // slots per second
+    f32 spacing;    // pixels between slots
+    v2 origin;      // where the child at offset sits
+} Carousel;
+
+typedef struct {
+    i32 slot;
+} CarouselItem;
+
+ecs_entity_t createCarousel(v2 origin, f32 spacing);
+void carouselAdd(ecs_entity_t carousel, ecs_entity_t child);
+bool carouselScroll(ecs_entity_t carousel, i32 step);
+
+void CarouselModuleImport(ecs_world_t* world);
@@ -0,0 +1,68 @@
+#pragma once
+#include "defs.h"
+#include "flecs.h"
+
+// Input is read from raylib once per frame into the InputState singleton by
+// PollInput, which is tagged _frameStart so simBeginFrame runs it before the
+// fixed steps. Systems read the snapshot instead of polling raylib, which makes
+// it safe from worker threads and lets a replay stand in for the real devices.
+// Edges (pressed/released) hold for the whole frame, for the frame's systems.
+// Fixed-step systems read step instead: it latches every edge until a fixed
+// step has run with it and is cleared after that step, so an edge is seen by
+// exactly one step, even when frames run without any. frameTime is the one to
+// step by, since during a replay it is the recorded one.
+
+#define INPUT_MAX_KEYS 352 // raylib's highest key code is KEY_KB_MENU, 348
+#define INPUT_KEY_WORDS ((INPUT_MAX_KEYS + 63) / 64)
+#define INPUT_MAX_BUTTONS 7 // MOUSE_BUTTON_LEFT to MOUSE_BUTTON_BACK
+
+extern ECS_COMPONENT_DECLARE(InputState);
+extern ECS_SYSTEM_DECLARE(PollInput);
+extern ECS_SYSTEM_DECLARE(ConsumeStepEdges);
+
+typedef struct {
+    u64 keysPressed[INPUT_KEY_WORDS];
+    u8 buttonsPressed; // bit per MouseButton
+    u8 buttonsReleased;
+} InputEdges;
+
+typedef struct {
+    u64 keysDown[INPUT_KEY_WORDS];
+    u64 keysPressed[INPUT_KEY_WORDS];
+    u8 buttonsDown;     // bit per MouseButton
+    u8 buttonsPressed;
+    u8 buttonsReleased;
+    v2 mouse;           // in the game's screen space, not the window's
+    f32 scale;          // window pixels per game pixel
+    f32 frameTime;
+    InputEdges step;    // edges no fixed step has seen yet
+} InputState;
+
+static inline bool inputKeyDown(const InputState* in, i32 key) {
+    return (u32)key < INPUT_MAX_KEYS && (in->keysDown[key / 64] >> (key % 64)) & 1;
+}
+
+static inline bool inputKeyPressed(const InputState* in, i32 key) {
+    return (u32)key < INPUT_MAX_KEYS &&
+           (in->keysPressed[key / 64] >> (key % 64)) & 1;
+}
+
+static inline bool inputButtonDown(const InputState* in, i32 button) {
+    return (in->buttonsDown >> button) & 1;
+}
+
+static inline bool inputButtonPressed(const InputState* in, i32 button) {
+    return (in->buttonsPressed >> button) & 1;
+}
+
+static inline bool inputStepKeyPressed(const InputState* in, i32 key) {
+    return (u32)key < INPUT_MAX_KEYS &&
+           (in->step.keysPressed[key / 64] >> (key % 64)) & 1;
+}
+
+static inline bool inputStepButtonPressed(const InputState* in, i32 button) {
+    return (in->step.buttonsPressed >> button) & 1;
+}
+
+void inputPoll(InputState* in);
+void InputModuleImport(ecs_world_t* world);
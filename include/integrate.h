@@ -0,0 +1,19 @@
+#pragma once
+#include "defs.h"
+
+// Semi-implicit Euler over interleaved {x, y} columns, as flecs stores
+// position_c and velocity_c. The step is the same for every entity, so it is
+// hoisted out of the loop. The loop works on INTEGRATE_LANES floats, which is
+// four entities, at a time using GCC vector extensions; without AVX the
+// compiler splits each operation into two SSE ones.
+//
+//   v = (v + a * dt) / (1 + drag * dt)
+//   p = p + v * dt
+//
+// accel and drag may be NULL. drag is one coefficient per entity, in 1/s.
+// With neither, vel is only read.
+
+#define INTEGRATE_LANES 8
+
+void integrate(f32* restrict pos, f32* restrict vel, const f32* restrict accel,
+               const f32* restrict drag, usize count, f32 dt);
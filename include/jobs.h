@@ -0,0 +1,13 @@
+#pragma once
+#include "defs.h"
+
+// Fixed pool of worker threads pulling from one FIFO queue. Jobs must not
+// call raylib functions that touch the GL context or window.
+
+typedef void (*JobFn)(void* arg);
+
+void jobsInit(i32 threads);
+void jobsShutdown(void);
+void jobsSubmit(JobFn fn, void* arg);
+void jobsWait(void);
+i32 jobsThreadCount(void);
@@ -0,0 +1,33 @@
+#pragma once
+#include "defs.h"
+
+// Seedable, deterministic noise. Nothing here touches raylib state, so it is
+// safe to use headless and from worker threads.
+
+enum NoiseType { PERLIN, CELLULAR };
+
+typedef struct {
+    u64 state;
+} Rng;
+
+typedef struct {
+    enum NoiseType type;
+    u64 seed;
+    f32 frequency; // features across the width of the field
+    f32 offsetx;   // in feature units
+    f32 offsety;
+    i32 octaves;
+    f32 lacunarity;
+    f32 gain;
+    f32 warp; // domain warp strength in feature units, 0 disables it
+} NoiseDesc;
+
+Rng rngInit(u64 seed);
+u64 rngNext(Rng* rng);
+i32 rngRange(Rng* rng, i32 min, i32 max);
+
+NoiseDesc noiseDefaults(enum NoiseType type, u64 seed, f32 frequency);
+f32 noiseSample(const NoiseDesc* d, f32 x, f32 y);
+void noiseOctaveSeeds(const NoiseDesc* d, u32* seeds, i32 count);
+void noiseFieldF32(f32* out, i32 w, i32 h, const NoiseDesc* d);
+void noiseFieldU8(u8* out, i32 w, i32 h, const NoiseDesc* d);
@@ -0,0 +1,28 @@
+#pragma once
+#include "defs.h"
+
+// In-place kernels over the RGBA8 buffer of an Image. Each one touches every
+// pixel exactly once; the only allocations are the cached shade tables.
+
+#define SHADE_TABLE_MAX 16
+
+// per pixel shadow falloff and circle mask for one (size, shadow centre) pair
+typedef struct {
+    i32 w, h;
+    i32 cx, cy;
+    f32* falloff;
+    u8* inside;
+} ShadeTable;
+
+Color* imageRGBA8(Image* img);
+Image imageAllocRGBA8(i32 w, i32 h);
+
+void pixAverage(Color* dst, const Color* a, const Color* b, usize count);
+void pixCropToCircle(Color* px, i32 w, i32 h);
+void pixShadow(Color* px, i32 w, i32 h, i32 cx, i32 cy);
+void pixShadeDisc(Color* px, i32 w, i32 h, i32 cx, i32 cy);
+void pixTerrain(Color* dst, const u8* n1, const u8* n2, const Color* lut, i32 w,
+                i32 h, i32 cx, i32 cy);
+
+const ShadeTable* pixShadeTable(i32 w, i32 h, i32 cx, i32 cy);
+void pixFreeShadeTables(void);
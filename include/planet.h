@@ -1,25 +1,28 @@
 #pragma once
 #include "defs.h"
 #include "flecs.h"
+#include "planetBackend.h"
+#include "planetGen.h"
+#include <stdatomic.h>
 
-#define MAX_COLORRAMP_STEPS 10
-#define PLANET_RES 128
-#define ATMOSPHERE_SCALE 1.05
-#define PLANET_NAME_MAXLEN 32
-#define PLANET_NAME_SIZE 22
 #define PLANET_MAX_SCROLLABLE 10
+#define PLANET_UPLOADS_PER_FRAME 1
+#define PLANET_BACKGROUNDS_RESIDENT 3
+#define CLICKABLE_MAX_HOVERED 16
+#define PLANET_RENDER_LAYER 1 // and the two layers above it
 
 extern ECS_COMPONENT_DECLARE(Planet);
-extern ECS_TAG_DECLARE(_scrollablePlanet);
 extern ECS_COMPONENT_DECLARE(Clickable);
+extern ECS_COMPONENT_DECLARE(PlanetPending);
+extern ECS_TAG_DECLARE(_hovered);
 extern ECS_SYSTEM_DECLARE(HandleClickables);
+extern ECS_SYSTEM_DECLARE(SyncClickables);
+extern ECS_SYSTEM_DECLARE(StreamPlanets);
+extern ECS_SYSTEM_DECLARE(DrawPlanets);
 
-typedef struct {
-    usize len;
-    Color colors[MAX_COLORRAMP_STEPS];
-    i32 steps[MAX_COLORRAMP_STEPS];
-} ColorRamp;
+extern const PlanetBackend* planetBackend;
 
+// onHover and hoverReset fire once each, when the mouse enters and leaves
 typedef struct {
     void (*onClick)(ecs_entity_t e);
     void (*onHover)(ecs_entity_t e);
@@ -29,38 +32,41 @@ typedef struct {
 
 typedef struct {
     Texture2D land;
-    Texture2D background;
     Texture2D atmosphere;
     ColorRamp palette;
     Color avg;
     i32 atmosphereOffset;
-    u8 order;
+    u64 seed;
     f32 scale;
     char name[PLANET_NAME_MAXLEN];
 } Planet;
 
-enum NoiseType { PERLIN, CELLULAR };
-
-ColorRamp createColorRamp(i32* steps, Color* colors, usize len);
-ColorRamp createColorRampAuto(Color* colors, usize len, i32 max);
-Image colorPerlin(enum NoiseType type, usize res, ColorRamp ramp, f32 scale);
-
-Image dither(i32 circleOffsetx, i32 circleOffsety, Image m);
-Image cropToCircle(Image img);
-Color* generateHarmonizedColors(Color baseColor, i32 colorCount, i32 hueShift,
-                                f32 saturationFactor, f32 brightnessFactor);
+// background generation for one planet; ready is set by the worker
+typedef struct {
+    PlanetImages imgs;
+    atomic_bool ready;
+} PlanetJob;
 
-void planetTest();
-Color getRandomColor();
+// present while the planet's textures have not been uploaded yet
+typedef struct {
+    PlanetJob* job;
+} PlanetPending;
 
-void drawColorRamp(const ColorRamp* ramp);
-Color brightenColor(Color c);
+void drawColorRamp(u32 layer, const ColorRamp* ramp);
 
-Color averageRamp(const ColorRamp* ramp);
+ecs_entity_t spawnPlanetPending(v2 pos, f32 scale, u64 seed);
+void preparePlanetImages(PlanetImages* imgs, u64 seed);
+void uploadPlanet(Planet* p, const PlanetImages* imgs);
+ecs_entity_t spawnPlanet(v2 pos, f32 scale, const PlanetImages* imgs);
+void streamPlanet(ecs_entity_t e);
+Texture2D planetBackground(const Planet* p);
+void unloadPlanetBackgrounds(void);
+void unloadPendingPlanets(void);
 ecs_entity_t createPlanet(v2 pos, f32 scale);
-ecs_entity_t createPlanetContainer(i32 count);
-void scrollPlanet(ecs_entity_t container, bool direction, bool increase, bool* done);
+ecs_entity_t createPlanetFromSeed(v2 pos, f32 scale, u64 seed);
+ecs_entity_t createPlanetContainer(i32 count, u64 seed);
 
+void planetPreferGPU(bool prefer);
 void PlanetModuleImport(ecs_world_t* world);
 
 Texture2D genCosmicBackground();
@@ -0,0 +1,31 @@
+#pragma once
+#include "defs.h"
+#include "planetGen.h"
+
+// Backends that turn a PlanetLayerDesc into the land and atmosphere layers.
+// The CPU backend is the image pipeline in planetGen.c; it needs no GPU and
+// works headless. The GPU backend draws each layer with a fragment shader into
+// a RenderTexture2D, one draw call per layer, and needs a window.
+
+#define PLANET_SHADER_PATH "assets/shaders/planet.fs"
+
+// backends match when at most PLANET_BACKEND_MAX_MISMATCH of the pixels have a
+// channel more than PLANET_BACKEND_TOLERANCE apart. float rounding on the GPU
+// can push a noise value across a ramp step, so a few pixels may differ a lot
+#define PLANET_BACKEND_TOLERANCE 2
+#define PLANET_BACKEND_MAX_MISMATCH 0.005
+
+typedef struct {
+    const char* name;
+    bool threaded; // images may be called from worker threads
+    bool (*init)(void); // false when the backend can't run on this machine
+    void (*shutdown)(void);
+    void (*images)(const PlanetLayerDesc* d, Image* land, Image* atmosphere);
+    void (*textures)(const PlanetLayerDesc* d, Texture2D* land,
+                     Texture2D* atmosphere);
+} PlanetBackend;
+
+extern const PlanetBackend planetBackendCPU;
+extern const PlanetBackend planetBackendGPU;
+
+const PlanetBackend* planetBackendSelect(bool preferGPU);
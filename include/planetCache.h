@@ -0,0 +1,16 @@
+#pragma once
+#include "defs.h"
+#include "planetGen.h"
+
+// On-disk cache of generated planets. One file per planet, named by its seed
+// and a hash of the generation parameters. The file is a fixed header
+// followed by the raw RGBA8 layers, so a hit is an mmap and no decode.
+
+#define PLANET_CACHE_DIR "cache/planets"
+#define PLANET_CACHE_MAGIC 0x4c504143 // "CAPL"
+
+u64 planetParamsHash(void);
+bool planetCacheLoad(PlanetImages* out, u64 seed);
+bool planetCacheStore(const PlanetImages* imgs);
+void planetCacheSweep(void);
+void loadOrGeneratePlanetImages(PlanetImages* out, u64 seed);
@@ -0,0 +1,85 @@
+#pragma once
+#include "defs.h"
+#include "noise.h"
+
+// CPU side of planet generation. Nothing declared here needs a window, a GL
+// context or the ECS world, so it also builds into the headless bench.
+
+#define MAX_COLORRAMP_STEPS 10
+#define PLANET_RES 128
+#define PLANET_BG_RES 640
+#define ATMOSPHERE_SCALE 1.05
+#define PLANET_NAME_MAXLEN 32
+#define PLANET_NAME_SIZE 22
+
+// bump whenever generation output changes, so cached planets are regenerated
+#define PLANET_GEN_VERSION 2
+
+typedef struct {
+    usize len;
+    Color colors[MAX_COLORRAMP_STEPS];
+    i32 steps[MAX_COLORRAMP_STEPS];
+} ColorRamp;
+
+// everything the land and atmosphere layers are generated from
+typedef struct {
+    u64 landSeed;
+    i32 res;
+    i32 shadowOffsetx;
+    i32 shadowOffsety;
+    ColorRamp palette;
+    Color atmColor;
+} PlanetLayerDesc;
+
+// CPU side of a planet, produced off the render thread by generatePlanetImages.
+// the background is not part of it; it is generated when the planet is selected
+typedef struct {
+    u64 seed;
+    ColorRamp palette;
+    Color atmColor;
+    PlanetLayerDesc layers;
+    Image land;
+    Image atmosphere;
+    char name[PLANET_NAME_MAXLEN];
+    void* mapping; // set when the layers point into a mapped cache file
+    usize mappingSize;
+} PlanetImages;
+
+extern char** planetNames;
+extern usize planetNameCount;
+
+ColorRamp createColorRamp(i32* steps, Color* colors, usize len);
+ColorRamp createColorRampAuto(Color* colors, usize len, i32 max);
+Image colorPerlin(enum NoiseType type, usize res, ColorRamp ramp, f32 scale,
+                  u64 seed);
+Image generatePlanetLand(usize res, ColorRamp ramp, i32 shadowOffsetx,
+                         i32 shadowOffsety, u64 seed);
+Image generatePlanetAtmosphere(usize res, Color color, i32 shadowOffsetx,
+                               i32 shadowOffsety);
+void planetNoiseDescs(enum NoiseType type, usize res, f32 customScale, Rng* rng,
+                      NoiseDesc* d1, NoiseDesc* d2);
+void rampLUT(const ColorRamp* ramp, Color lut[256]);
+
+Image averageImages(Image m1, Image m2);
+Image dither(i32 circleOffsetx, i32 circleOffsety, Image m);
+Image cropToCircle(Image img);
+void ditherImage(i32 circleOffsetx, i32 circleOffsety, Image* m);
+void cropToCircleImage(Image* img);
+Color* generateHarmonizedColors(Color baseColor, i32 colorCount, i32 hueShift,
+                                f32 saturationFactor, f32 brightnessFactor);
+
+void planetTest();
+void printTestRes(const char* txt, bool passed);
+Color getRandomColor(Rng* rng);
+u64 randomSeed();
+Color brightenColor(Color c);
+Color averageRamp(const ColorRamp* ramp);
+
+void loadPlanetNames();
+const char* getPlanetName(Rng* rng);
+
+Image generatePlanetBackground(ColorRamp palette, u64 seed);
+void describePlanet(PlanetImages* out, u64 seed);
+void generatePlanetLayers(const PlanetLayerDesc* d, Image* land, Image* atmosphere);
+void generatePlanetImages(PlanetImages* out, u64 seed);
+void unloadPlanetImages(PlanetImages* imgs);
@@ -0,0 +1,60 @@
+#pragma once
+#include "defs.h"
+#include "flecs.h"
+#include <stdatomic.h>
+
+// Frame profiler. Every game system's callback is timed with the same clock as
+// the scopes and sampled once a frame, and code outside systems is timed with
+// profileBegin/profileEnd scopes, which are safe on any thread. Each entry keeps
+// its last PROFILER_WINDOW samples for the overlay's p50/p99. With tracing on,
+// scopes and per-frame system times are also logged for a Chrome trace
+// (chrome://tracing or ui.perfetto.dev).
+//
+// While the profiler is off a scope, and the wrapper around each system, is
+// one relaxed load and a branch.
+
+#define PROFILER_WINDOW 240     // samples the percentiles are taken over
+#define PROFILER_MAX_ENTRIES 64
+#define PROFILER_MAX_EVENTS (1 << 20) // trace events kept, 32 MB; later ones drop
+
+typedef struct {
+    const char* name; // NULL when the profiler was off at profileBegin
+    u64 start;
+} ProfileScope;
+
+typedef struct {
+    const char* name;
+    usize samples;
+    f32 p50, p99; // ms
+} ProfileStat;
+
+extern atomic_bool profilerOn;
+
+u64 profileNow(void);
+void profileRecord(const char* name, u64 start, u64 end);
+
+// name must outlive the profiler, a string literal in practice
+static inline ProfileScope profileBegin(const char* name) {
+    if (!atomic_load_explicit(&profilerOn, memory_order_relaxed)) {
+        return (ProfileScope){0};
+    }
+    return (ProfileScope){name, profileNow()};
+}
+
+static inline void profileEnd(ProfileScope s) {
+    if (s.name != NULL) profileRecord(s.name, s.start, profileNow());
+}
+
+// profiler.c, plain C that the benchmarks link too
+void profilerSetOn(bool on);
+void profileSystem(const char* name, u64 frameEnd, u64 dur);
+usize profilerStats(ProfileStat* out, usize max);
+bool profilerTrace(void);
+bool profilerWriteTrace(const char* path);
+bool profilerWriteCsv(const char* path);
+void profilerShutdown(void);
+
+// profilerFrame.c, the flecs and raylib side
+void profilerEnable(ecs_world_t* world, bool enable);
+void profilerEndFrame(ecs_world_t* world);
+void profilerDrawOverlay(void);
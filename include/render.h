@@ -1,13 +1,97 @@
 #pragma once
 #include "defs.h"
 #include "flecs.h"
+#include "textCache.h"
 
-extern ECS_COMPONENT_DECLARE(Renderable);
-extern ECS_SYSTEM_DECLARE(render_s);
+// Rendering goes through a per frame command queue. Systems append draw
+// commands during PreStore; RenderSubmit (OnStore) binds the render target,
+// sorts the commands by layer, then by texture, and issues them. Nothing is
+// bound before the submit, so earlier systems are free to draw into their own
+// render textures. raylib merges consecutive draws that use the
+// same texture into one batch, so the sort is what keeps GL state changes
+// down. Within a layer draw order is only kept between commands that share a
+// texture, so anything that must overlap in a set order needs its own layer.
+
+#define RENDER_QUEUE_START 256
+#define RENDER_TEXT_START 4096
+#define RENDER_BACKGROUND_LAYER 0
+
+extern ECS_COMPONENT_DECLARE(Sprite);
+extern ECS_SYSTEM_DECLARE(DrawSprites);
+extern ECS_SYSTEM_DECLARE(RenderSubmit);
+
+// drawn at the entity's position_c plus offset
+typedef struct {
+    Texture2D tex;
+    Rect src;
+    v2 offset;
+    f32 scale;
+    Color tint;
+    u32 layer;
+} Sprite;
+
+typedef enum {
+    RENDER_QUAD,
+    RENDER_TEXT,
+    RENDER_TEXT_RUN,
+    RENDER_RECT,
+    RENDER_ROUNDED_RECT,
+    RENDER_CIRCLE_LINES,
+    RENDER_LINE,
+} RenderCmdType;
+
+typedef struct {
+    RenderCmdType type;
+    u32 layer;
+    u32 texture; // sort key within the layer
+    Color tint;
+    union {
+        struct {
+            Texture2D tex;
+            Rect src;
+            Rect dst;
+        } quad;
+        struct {
+            Font font;
+            usize offset; // into the frame's text buffer
+            v2 pos;
+            f32 size;
+            f32 spacing;
+        } text;
+        struct {
+            const TextRun* run;
+            v2 pos;
+        } run;
+        struct {
+            Rect rect;
+            f32 roundness;
+            i32 segments;
+        } rect;
+        struct {
+            v2 a;
+            v2 b; // line end
+            f32 radius; // circle radius, or line thickness
+        } shape;
+    };
+} RenderCmd;
 
 typedef struct {
-    u32 renderLayer;
-    void (*render)(ecs_entity_t e);
-} Renderable;
+    u32 commands;
+    u32 textureSwitches;
+} RenderStats;
+
+void renderQuad(u32 layer, Texture2D tex, Rect src, Rect dst, Color tint);
+void renderTexture(u32 layer, Texture2D tex, v2 pos, f32 scale, Color tint);
+void renderText(u32 layer, Font font, const char* text, v2 pos, f32 size,
+                f32 spacing, Color tint);
+void renderTextRun(u32 layer, const TextRun* run, v2 pos, Color tint);
+void renderRect(u32 layer, Rect rect, Color color);
+void renderRoundedRect(u32 layer, Rect rect, f32 roundness, i32 segments,
+                       Color color);
+void renderCircleLines(u32 layer, v2 center, f32 radius, Color color);
+void renderLine(u32 layer, v2 start, v2 end, f32 thick, Color color);
+void renderSetTarget(RenderTexture2D target);
+RenderStats renderLastStats(void);
+Sprite spriteOf(Texture2D tex, u32 layer);
 
 void RendererModuleImport(ecs_world_t* world);
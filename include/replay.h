@@ -0,0 +1,31 @@
+#pragma once
+#include "defs.h"
+#include "input.h"
+
+// Records the InputState of every frame, along with the seeds the session was
+// started with, so a run can be played back exactly. Each frame stores the
+// frame time, mouse and buttons, and only the keys whose state changed, so a
+// minute of play is a few tens of kilobytes. Playback runs in a hidden window,
+// not headless, so it still needs a display and a GL driver.
+
+#define REPLAY_MAGIC 0x50524750u // "PGRP"
+#define REPLAY_VERSION 1
+
+typedef enum {
+    REPLAY_OFF,
+    REPLAY_RECORDING,
+    REPLAY_PLAYING,
+} ReplayMode;
+
+typedef struct {
+    u32 randomSeed;   // what raylib's GetRandomValue was seeded with
+    u64 universeSeed; // what the planet carousel was generated from
+} ReplaySeeds;
+
+bool replayRecord(const char* path, ReplaySeeds seeds);
+bool replayPlay(const char* path, ReplaySeeds* seeds);
+ReplayMode replayMode(void);
+bool replayFinished(void);
+void replayWrite(const InputState* in);
+bool replayRead(InputState* in);
+void replayClose(void);
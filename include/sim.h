@@ -0,0 +1,29 @@
+#pragma once
+#include "defs.h"
+#include "flecs.h"
+
+// The simulation runs on a fixed timestep, decoupled from rendering. Systems
+// tagged _fixedStep are left out of the frame's ecs_progress and run by
+// simAdvance in whole SIM_DT steps, so their results don't depend on the frame
+// rate. They step by SIM_DT rather than it->delta_time, which is the frame's.
+// The time left over, as a fraction of a step, is what rendering interpolates
+// by. Systems tagged _frameStart, such as input polling, are run by
+// simBeginFrame, ahead of the steps and of whatever decides the frame time.
+
+#define SIM_HZ 120
+#define SIM_DT (1.0f / SIM_HZ)
+#define SIM_MAX_STEPS 8 // per frame; after a long stall the rest is dropped
+
+// Both pipelines run on flecs worker threads, but only systems created with
+// multi_threaded split their entities across them. Every other system runs on
+// the main thread, which is where anything calling raylib or reading input
+// has to stay.
+
+extern ECS_TAG_DECLARE(_fixedStep);
+extern ECS_TAG_DECLARE(_frameStart);
+
+void simBeginFrame(ecs_world_t* world);
+i32 simAdvance(ecs_world_t* world, f32 frameTime);
+f32 simAlpha(void);
+void simSetThreads(ecs_world_t* world, i32 count);
+void SimModuleImport(ecs_world_t* world);
@@ -0,0 +1,20 @@
+#pragma once
+#include "defs.h"
+
+// Uniform grid for point queries against many rectangles. Cells are hashed
+// into a fixed set of buckets, so the grid covers all of world space without
+// bounds or rebuilds. Moving a box within the cells it covers only updates
+// the box; moving it to other cells relinks every cell it covers.
+// Keys are caller chosen and must be non-zero (entity ids work).
+
+#define GRID_CELL_SIZE 64
+#define GRID_BUCKETS 256 // power of two
+
+typedef struct SpatialGrid SpatialGrid;
+
+SpatialGrid* gridCreate(f32 cellSize);
+void gridDestroy(SpatialGrid* g);
+void gridUpdate(SpatialGrid* g, u64 key, Rect box);
+void gridRemove(SpatialGrid* g, u64 key);
+usize gridQueryPoint(const SpatialGrid* g, v2 p, u64* out, usize max);
+usize gridCount(const SpatialGrid* g);
@@ -7,8 +7,7 @@ extern ecs_world_t* world;
 extern const u32 screenWidth;
 extern const u32 screenHeight;
 extern Font globalFont;
-extern v2* mouse;
-extern const Planet* selectedPlanet_p;
+extern ecs_entity_t selectedPlanet_e;
 
 enum GameState {
     MAIN_MENU,
@@ -0,0 +1,43 @@
+#pragma once
+#include "defs.h"
+
+// Text laid out once per (font, size, spacing, text) into glyph quads, so
+// drawing static text needs no per-frame measuring or glyph lookups. Runs that
+// go unused are evicted once the cache holds more than TEXT_CACHE_SIZE, but
+// never during the frame they were last used in, so the render queue can keep
+// pointers to them until the submit.
+//
+// Baked runs are rasterized once into a shared atlas and drawn as one quad.
+// They are white (tint them when drawing), and they are pinned: never evicted,
+// even if the atlas was full and they kept their glyphs. Atlas space is not
+// reclaimed, so only bake text that lives as long as the game.
+
+#define TEXT_CACHE_SIZE 128
+#define TEXT_ATLAS_SIZE 512
+#define TEXT_LINE_SPACING 2 // raylib's default, it has no getter
+
+typedef struct {
+    Rect src;
+    Rect dst; // relative to where the run is drawn
+} GlyphQuad;
+
+typedef struct {
+    u64 hash;
+    char* text;
+    u32 font; // texture id of the font the run was laid out with
+    f32 size;
+    f32 spacing;
+    bool pinned;
+    bool baked;
+    Texture2D tex; // the font's texture, or the atlas once baked
+    GlyphQuad* quads;
+    u32 count;
+    v2 extent; // as MeasureTextEx returns it
+    u64 lastFrame;
+} TextRun;
+
+const TextRun* textRun(Font font, const char* text, f32 size, f32 spacing);
+const TextRun* textRunBaked(Font font, const char* text, f32 size, f32 spacing);
+void drawTextRun(const TextRun* run, v2 pos, Color tint);
+void textCacheNextFrame(void);
+void textCacheClear(void);
@@ -5,11 +5,19 @@
 typedef struct {
     f32 x;
     f32 y;
-} position_c, velocity_c;
+} position_c, velocity_c, prevPosition_c, acceleration_c;
+
+// velocity lost per second, relative to the current velocity
+typedef struct {
+    f32 coefficient;
+} drag_c;
 
 extern ECS_TAG_DECLARE(_controllable);
 extern ECS_COMPONENT_DECLARE(velocity_c);
 extern ECS_COMPONENT_DECLARE(position_c);
+extern ECS_COMPONENT_DECLARE(prevPosition_c);
+extern ECS_COMPONENT_DECLARE(acceleration_c);
+extern ECS_COMPONENT_DECLARE(drag_c);
 extern ECS_SYSTEM_DECLARE(Move);
 extern ECS_SYSTEM_DECLARE(Controller);
 
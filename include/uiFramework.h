@@ -1,12 +1,16 @@
 #pragma once
 #include "defs.h"
 #include "flecs.h"
+#include "textCache.h"
+
+#define TEXTBOX_LAYER 5
 
 typedef struct {
     const char* text;
     v2 offset;
     Texture2D icon;
     f32 fontSize;
+    const TextRun* run;
 } label_c;
 
 typedef ecs_entity_t textbox_e;
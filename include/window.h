@@ -4,8 +4,12 @@
 
 #define MAG(v) sqrt(v.x* v.x + v.y * v.y)
 
+// the simulation steps at a fixed rate, so these only pace rendering
+#define WINDOW_VSYNC true
+#define WINDOW_TARGET_FPS 0 // 0 leaves it uncapped
+
 v2 getScreenMousePos(v2* mouse, f32 scale, i32 sw, i32 sh);
 void drawScaledWindow(RenderTexture2D target, f32 sw, f32 sh, f32 scale);
 v2 v2Clamp(v2 vec, v2 min, v2 max);
-void setWindowFlags(void);
+void setWindowFlags(bool hidden);
 f32 getWindowScale();
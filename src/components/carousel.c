@@ -0,0 +1,127 @@
+#include "carousel.h"
+#include "sim.h"
+#include "state.h"
+#include "transform.h"
+#include <math.h>
+
+ECS_COMPONENT_DECLARE(Carousel);
+ECS_COMPONENT_DECLARE(CarouselItem);
+ECS_TAG_DECLARE(_carouselAwake);
+ECS_SYSTEM_DECLARE(AnimateCarousels);
+
+// every carousel item, disabled ones included, grouped by parent
+static ecs_query_t* itemQuery;
+
+// exact step of a critically damped spring towards target, stable for any dt
+static void springStep(f32* x, f32* v, f32 target, f32 omega, f32 dt) {
+    f32 y = *x - target;
+    f32 decay = expf(-omega * dt);
+    f32 tmp = (*v + omega * y) * dt;
+
+    *v = (*v - omega * tmp) * decay;
+    *x = target + (y + tmp) * decay;
+}
+
+// keeps where the item was a step ago in prev, so it is drawn in between
+static void placeItem(ecs_world_t* world, ecs_entity_t e, const Carousel* c,
+                      i32 slot, position_c* pos, prevPosition_c* prev) {
+    *prev = *pos;
+    pos->x = c->origin.x + (slot - c->offset) * c->spacing;
+    pos->y = c->origin.y;
+
+    bool visible = fabsf(slot - c->offset) <= CAROUSEL_VISIBLE;
+    if (visible == ecs_has_id(world, e, EcsDisabled)) {
+        ecs_enable(world, e, visible);
+    }
+}
+
+// a settled carousel stops being stepped, so its items' prev is snapped too,
+// or they would keep being drawn between their last two places
+static void layoutCarousel(ecs_world_t* world, ecs_entity_t carousel,
+                           const Carousel* c, bool settled) {
+    ecs_iter_t it = ecs_query_iter(world, itemQuery);
+    ecs_iter_set_group(&it, carousel);
+
+    while (ecs_query_next(&it)) {
+        const CarouselItem* item = ecs_field(&it, CarouselItem, 0);
+        position_c* p = ecs_field(&it, position_c, 1);
+        prevPosition_c* prev = ecs_field(&it, prevPosition_c, 2);
+
+        for (i32 i = 0; i < it.count; i++) {
+            placeItem(world, it.entities[i], c, item[i].slot, &p[i], &prev[i]);
+            if (settled) prev[i] = p[i];
+        }
+    }
+}
+
+void AnimateCarousels(ecs_iter_t* it) {
+    Carousel* c = ecs_field(it, Carousel, 0);
+
+    for (i32 i = 0; i < it->count; i++) {
+        springStep(&c[i].offset, &c[i].velocity, c[i].index, CAROUSEL_OMEGA,
+                   SIM_DT);
+
+        bool settled = fabsf(c[i].offset - c[i].index) < CAROUSEL_EPSILON &&
+                       fabsf(c[i].velocity) < CAROUSEL_EPSILON;
+        if (settled) {
+            c[i].offset = c[i].index;
+            c[i].velocity = 0;
+            ecs_remove(it->world, it->entities[i], _carouselAwake);
+        }
+
+        layoutCarousel(it->world, it->entities[i], &c[i], settled);
+    }
+}
+
+ecs_entity_t createCarousel(v2 origin, f32 spacing) {
+    ecs_entity_t e = ecs_new(world);
+    ecs_set(world, e, Carousel, {.spacing = spacing, .origin = origin});
+    return e;
+}
+
+// appends child as the last slot of carousel and places it right away
+void carouselAdd(ecs_entity_t carousel, ecs_entity_t child) {
+    Carousel* c = ecs_get_mut(world, carousel, Carousel);
+    i32 slot = c->count++;
+
+    ecs_add_pair(world, child, EcsChildOf, carousel);
+    ecs_set(world, child, CarouselItem, {slot});
+
+    position_c pos = {0};
+    prevPosition_c prev;
+    placeItem(world, child, c, slot, &pos, &prev);
+    ecs_set_ptr(world, child, position_c, &pos);
+    ecs_set_ptr(world, child, prevPosition_c, &pos);
+}
+
+// moves the target by step slots. false if that would leave the carousel
+bool carouselScroll(ecs_entity_t carousel, i32 step) {
+    Carousel* c = ecs_get_mut(world, carousel, Carousel);
+    i32 index = c->index + step;
+    if (index < 0 || index >= c->count) return false;
+
+    c->index = index;
+    ecs_add(world, carousel, _carouselAwake);
+    return true;
+}
+
+void CarouselModuleImport(ecs_world_t* world) {
+    ECS_IMPORT(world, SimModule);
+    ECS_IMPORT(world, TransformModule);
+    ECS_MODULE(world, CarouselModule);
+
+    ECS_COMPONENT_DEFINE(world, Carousel);
+    ECS_COMPONENT_DEFINE(world, CarouselItem);
+    ECS_TAG_DEFINE(world, _carouselAwake);
+    ECS_SYSTEM_DEFINE(world, AnimateCarousels, EcsOnUpdate, Carousel,
+                      _carouselAwake);
+    ecs_add(world, ecs_id(AnimateCarousels), _fixedStep);
+
+    itemQuery =
+        ecs_query(world, {.terms = {{.id = ecs_id(CarouselItem), .inout = EcsIn},
+                                    {.id = ecs_id(position_c)},
+                                    {.id = ecs_id(prevPosition_c)}},
+                          .cache_kind = EcsQueryCacheAuto,
+                          .flags = EcsQueryMatchDisabled,
+                          .group_by = EcsChildOf});
+}
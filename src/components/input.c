@@ -0,0 +1,74 @@
+#include "input.h"
+#include "replay.h"
+#include "sim.h"
+#include "state.h"
+#include "window.h"
+#include <string.h>
+
+ECS_COMPONENT_DECLARE(InputState);
+ECS_SYSTEM_DECLARE(PollInput);
+ECS_SYSTEM_DECLARE(ConsumeStepEdges);
+
+// reads every key and button from raylib
+void inputPoll(InputState* in) {
+    memset(in, 0, sizeof(*in));
+
+    for (i32 key = 0; key < INPUT_MAX_KEYS; key++) {
+        u64 bit = 1ull << (key % 64);
+        if (IsKeyDown(key)) in->keysDown[key / 64] |= bit;
+        if (IsKeyPressed(key)) in->keysPressed[key / 64] |= bit;
+    }
+
+    for (i32 b = 0; b < INPUT_MAX_BUTTONS; b++) {
+        in->buttonsDown |= IsMouseButtonDown(b) << b;
+        in->buttonsPressed |= IsMouseButtonPressed(b) << b;
+        in->buttonsReleased |= IsMouseButtonReleased(b) << b;
+    }
+
+    in->scale = getWindowScale();
+    getScreenMousePos(&in->mouse, in->scale, screenWidth, screenHeight);
+    in->frameTime = GetFrameTime();
+}
+
+// adds the frame's edges to those still waiting for a fixed step
+static void latchEdges(InputState* in, InputEdges step) {
+    for (i32 i = 0; i < INPUT_KEY_WORDS; i++) {
+        step.keysPressed[i] |= in->keysPressed[i];
+    }
+    step.buttonsPressed |= in->buttonsPressed;
+    step.buttonsReleased |= in->buttonsReleased;
+    in->step = step;
+}
+
+// during playback the devices are ignored; once the log runs out the state is
+// left as it was and replayFinished reports it
+void PollInput(ecs_iter_t* it) {
+    InputState* in = ecs_field(it, InputState, 0);
+    InputEdges step = in->step;
+
+    if (replayMode() == REPLAY_PLAYING) {
+        if (replayRead(in)) latchEdges(in, step);
+        return;
+    }
+    inputPoll(in);
+    replayWrite(in);
+    latchEdges(in, step);
+}
+
+// last in each fixed step, so the next steps don't see the same edges again
+void ConsumeStepEdges(ecs_iter_t* it) {
+    InputState* in = ecs_field(it, InputState, 0);
+    in->step = (InputEdges){0};
+}
+
+void InputModuleImport(ecs_world_t* world) {
+    ECS_IMPORT(world, SimModule);
+    ECS_MODULE(world, InputModule);
+    ECS_COMPONENT_DEFINE(world, InputState);
+
+    ecs_singleton_set(world, InputState, {0});
+    ECS_SYSTEM_DEFINE(world, PollInput, EcsPreUpdate, [out] InputState($));
+    ecs_add(world, ecs_id(PollInput), _frameStart);
+    ECS_SYSTEM_DEFINE(world, ConsumeStepEdges, EcsPostFrame, [out] InputState($));
+    ecs_add(world, ecs_id(ConsumeStepEdges), _fixedStep);
+}
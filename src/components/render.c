@@ -1,42 +1,240 @@
 #include "render.h"
+#include "sim.h"
+#include "transform.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
 
-ECS_COMPONENT_DECLARE(Renderable);
-ECS_SYSTEM_DECLARE(renderSystem);
+ECS_COMPONENT_DECLARE(Sprite);
+ECS_SYSTEM_DECLARE(DrawSprites);
+ECS_SYSTEM_DECLARE(RenderSubmit);
 
-void render(ecs_iter_t* it) {
+// commands for the current frame, plus the sort keys that order them
+static RenderCmd* queue = NULL;
+static u64* keys = NULL;
+static u32 queueLen = 0;
+static u32 queueCap = 0;
 
-    const Renderable* s = ecs_field(it, Renderable, 0);
+// text is copied, since component storage may move before the submit
+static char* textBuf = NULL;
+static usize textLen = 0;
+static usize textCap = 0;
 
-    for (int i = 0; i < it->count; i++) {
-        s[i].render(it->entities[i]);
+static RenderStats lastStats;
+static RenderTexture2D target;
+
+static RenderCmd* pushCmd(RenderCmdType type, u32 layer, u32 texture, Color tint) {
+    if (queueLen == queueCap) {
+        u32 cap = queueCap == 0 ? RENDER_QUEUE_START : queueCap * 2;
+        RenderCmd* q = realloc(queue, sizeof(RenderCmd) * cap);
+        u64* k = realloc(keys, sizeof(u64) * cap);
+        if (q != NULL) queue = q;
+        if (k != NULL) keys = k;
+        if (q == NULL || k == NULL) {
+            perror("Error allocating memory in pushCmd");
+            return NULL;
+        }
+        queueCap = cap;
     }
+
+    RenderCmd* c = &queue[queueLen];
+    c->type = type;
+    c->layer = layer;
+    c->texture = texture;
+    c->tint = tint;
+
+    // layer, then texture, then submission order so the sort is stable
+    keys[queueLen] = ((u64)MIN(layer, 0xffff) << 48) |
+                     ((u64)(texture & 0xfffff) << 28) | queueLen;
+    queueLen++;
+    return c;
+}
+
+void renderQuad(u32 layer, Texture2D tex, Rect src, Rect dst, Color tint) {
+    RenderCmd* c = pushCmd(RENDER_QUAD, layer, tex.id, tint);
+    if (c == NULL) return;
+    c->quad.tex = tex;
+    c->quad.src = src;
+    c->quad.dst = dst;
 }
 
-int compareRenderable(ecs_entity_t e1, const void* ptr1, ecs_entity_t e2,
-                      const void* ptr2) {
-    (void)e1;
-    (void)e2;
-    const Renderable* r1 = ptr1;
-    const Renderable* r2 = ptr2;
+// the queued version of DrawTextureEx without rotation
+void renderTexture(u32 layer, Texture2D tex, v2 pos, f32 scale, Color tint) {
+    renderQuad(layer, tex, (Rect){0, 0, tex.width, tex.height},
+               (Rect){pos.x, pos.y, tex.width * scale, tex.height * scale}, tint);
+}
+
+void renderText(u32 layer, Font font, const char* text, v2 pos, f32 size,
+                f32 spacing, Color tint) {
+    usize len = strlen(text) + 1;
+    if (textLen + len > textCap) {
+        usize cap = MAX(textCap * 2, MAX(RENDER_TEXT_START, textLen + len));
+        char* buf = realloc(textBuf, cap);
+        if (buf == NULL) {
+            perror("Error allocating memory in renderText");
+            return;
+        }
+        textBuf = buf;
+        textCap = cap;
+    }
 
-    return r1->renderLayer - r2->renderLayer;
+    RenderCmd* c = pushCmd(RENDER_TEXT, layer, font.texture.id, tint);
+    if (c == NULL) return;
+    memcpy(textBuf + textLen, text, len);
+    c->text.font = font;
+    c->text.offset = textLen;
+    c->text.pos = pos;
+    c->text.size = size;
+    c->text.spacing = spacing;
+    textLen += len;
+}
+
+// a run from the text cache, which keeps it alive until the submit
+void renderTextRun(u32 layer, const TextRun* run, v2 pos, Color tint) {
+    if (run == NULL) return;
+    RenderCmd* c = pushCmd(RENDER_TEXT_RUN, layer, run->tex.id, tint);
+    if (c == NULL) return;
+    c->run.run = run;
+    c->run.pos = pos;
+}
+
+void renderRect(u32 layer, Rect rect, Color color) {
+    RenderCmd* c = pushCmd(RENDER_RECT, layer, GetShapesTexture().id, color);
+    if (c == NULL) return;
+    c->rect.rect = rect;
+}
+
+void renderRoundedRect(u32 layer, Rect rect, f32 roundness, i32 segments,
+                       Color color) {
+    RenderCmd* c = pushCmd(RENDER_ROUNDED_RECT, layer, GetShapesTexture().id, color);
+    if (c == NULL) return;
+    c->rect.rect = rect;
+    c->rect.roundness = roundness;
+    c->rect.segments = segments;
+}
+
+void renderCircleLines(u32 layer, v2 center, f32 radius, Color color) {
+    RenderCmd* c = pushCmd(RENDER_CIRCLE_LINES, layer, GetShapesTexture().id, color);
+    if (c == NULL) return;
+    c->shape.a = center;
+    c->shape.radius = radius;
+}
+
+void renderLine(u32 layer, v2 start, v2 end, f32 thick, Color color) {
+    RenderCmd* c = pushCmd(RENDER_LINE, layer, GetShapesTexture().id, color);
+    if (c == NULL) return;
+    c->shape.a = start;
+    c->shape.b = end;
+    c->shape.radius = thick;
+}
+
+static i32 compareKeys(const void* a, const void* b) {
+    u64 x = *(const u64*)a;
+    u64 y = *(const u64*)b;
+    return (x > y) - (x < y);
+}
+
+static void drawCmd(const RenderCmd* c) {
+    switch (c->type) {
+    case RENDER_QUAD:
+        DrawTexturePro(c->quad.tex, c->quad.src, c->quad.dst, (v2){0, 0}, 0,
+                       c->tint);
+        break;
+    case RENDER_TEXT:
+        DrawTextEx(c->text.font, textBuf + c->text.offset, c->text.pos,
+                   c->text.size, c->text.spacing, c->tint);
+        break;
+    case RENDER_TEXT_RUN:
+        drawTextRun(c->run.run, c->run.pos, c->tint);
+        break;
+    case RENDER_RECT:
+        DrawRectangleRec(c->rect.rect, c->tint);
+        break;
+    case RENDER_ROUNDED_RECT:
+        DrawRectangleRounded(c->rect.rect, c->rect.roundness, c->rect.segments,
+                             c->tint);
+        break;
+    case RENDER_CIRCLE_LINES:
+        DrawCircleLines(c->shape.a.x, c->shape.a.y, c->shape.radius, c->tint);
+        break;
+    case RENDER_LINE:
+        DrawLineEx(c->shape.a, c->shape.b, c->shape.radius, c->tint);
+        break;
+    }
+}
+
+// sorts and draws everything queued this frame, then empties the queue
+void RenderSubmit(ecs_iter_t* it) {
+    (void)it;
+
+    qsort(keys, queueLen, sizeof(u64), compareKeys);
+
+    RenderStats stats = {.commands = queueLen};
+    u32 texture = 0;
+
+    if (target.id != 0) {
+        BeginTextureMode(target);
+        ClearBackground(BLACK);
+    }
+
+    for (u32 i = 0; i < queueLen; i++) {
+        const RenderCmd* c = &queue[keys[i] & 0xfffffff];
+        stats.textureSwitches += c->texture != texture;
+        texture = c->texture;
+        drawCmd(c);
+    }
+
+    if (target.id != 0) EndTextureMode();
+
+    lastStats = stats;
+    queueLen = 0;
+    textLen = 0;
+    textCacheNextFrame();
+}
+
+// what RenderSubmit draws into; without one it draws into whatever is bound
+void renderSetTarget(RenderTexture2D t) { target = t; }
+
+RenderStats renderLastStats(void) { return lastStats; }
+
+// a sprite showing the whole texture at its natural size
+Sprite spriteOf(Texture2D tex, u32 layer) {
+    return (Sprite){.tex = tex,
+                    .src = {0, 0, tex.width, tex.height},
+                    .scale = 1,
+                    .tint = WHITE,
+                    .layer = layer};
+}
+
+// moving sprites are drawn between their last two simulated positions
+void DrawSprites(ecs_iter_t* it) {
+    const Sprite* s = ecs_field(it, Sprite, 0);
+    const position_c* pos = ecs_field(it, position_c, 1);
+    const prevPosition_c* prev = ecs_field(it, prevPosition_c, 2);
+    const f32 alpha = simAlpha();
+
+    for (int i = 0; i < it->count; i++) {
+        v2 at = {pos[i].x, pos[i].y};
+        if (prev != NULL) {
+            at.x = prev[i].x + (at.x - prev[i].x) * alpha;
+            at.y = prev[i].y + (at.y - prev[i].y) * alpha;
+        }
+
+        // a negative src size flips the sprite, it doesn't change its size
+        Rect dst = {at.x + s[i].offset.x, at.y + s[i].offset.y,
+                    fabsf(s[i].src.width) * s[i].scale,
+                    fabsf(s[i].src.height) * s[i].scale};
+        renderQuad(s[i].layer, s[i].tex, s[i].src, dst, s[i].tint);
+    }
 }
 
 void RendererModuleImport(ecs_world_t* world) {
+    ECS_IMPORT(world, TransformModule);
     ECS_MODULE(world, RendererModule);
-    ECS_COMPONENT_DEFINE(world, Renderable);
-
-    ecs_entity_t render_s = ecs_system(
-        world,
-        {.entity = ecs_entity(world,
-                              {.name = "renderSystem", // Name of the system
-                               .add = ecs_ids(ecs_dependson(EcsOnUpdate))}),
-         .query.terms =
-             {
-                 {.id = ecs_id(Renderable)} // Filter for entities with Renderable
-             },
-         .callback = render,
-         .query.order_by = ecs_id(Renderable),
-         .query.order_by_callback = compareRenderable});
-    (void)render_s;
+    ECS_COMPONENT_DEFINE(world, Sprite);
+
+    ECS_SYSTEM_DEFINE(world, DrawSprites, EcsPreStore, [in] Sprite,
+                      [in] transform.module.position_c,
+                      [in] ?transform.module.prevPosition_c);
+    ECS_SYSTEM_DEFINE(world, RenderSubmit, EcsOnStore, 0);
 }
@@ -0,0 +1,86 @@
+#include "sim.h"
+#include <unistd.h>
+
+ECS_TAG_DECLARE(_fixedStep);
+ECS_TAG_DECLARE(_frameStart);
+
+static ecs_entity_t startPipeline;
+static ecs_entity_t simPipeline;
+static ecs_entity_t framePipeline;
+static f32 accumulator = 0;
+
+// the builtin pipeline's ordering: by phase, then by when systems were made
+static int compareSystems(ecs_entity_t e1, const void* ptr1, ecs_entity_t e2,
+                          const void* ptr2) {
+    (void)ptr1;
+    (void)ptr2;
+    return (e1 > e2) - (e1 < e2);
+}
+
+static ecs_entity_t createPipeline(ecs_world_t* world, const char* name,
+                                   ecs_oper_kind_t fixedStep,
+                                   ecs_oper_kind_t frameStart) {
+    return ecs_pipeline(
+        world,
+        {.entity = ecs_entity(world, {.name = name}),
+         .query.terms = {{.id = EcsSystem},
+                         {.id = EcsPhase, .src.id = EcsCascade, .trav = EcsDependsOn},
+                         // OnStart systems run once, from the first ecs_progress
+                         {.id = ecs_dependson(EcsOnStart),
+                          .trav = EcsDependsOn,
+                          .oper = EcsNot},
+                         {.id = EcsDisabled,
+                          .src.id = EcsUp,
+                          .trav = EcsDependsOn,
+                          .oper = EcsNot},
+                         {.id = EcsDisabled,
+                          .src.id = EcsUp,
+                          .trav = EcsChildOf,
+                          .oper = EcsNot},
+                         {.id = _fixedStep, .oper = fixedStep},
+                         {.id = _frameStart, .oper = frameStart}},
+         .query.order_by_callback = compareSystems});
+}
+
+void simBeginFrame(ecs_world_t* world) {
+    ecs_run_pipeline(world, startPipeline, 0);
+}
+
+// runs as many fixed steps as frameTime makes up, returns how many ran
+i32 simAdvance(ecs_world_t* world, f32 frameTime) {
+    i32 steps = 0;
+    accumulator += frameTime;
+
+    // a step isn't a frame: ecs_progress would also advance the frame count and
+    // world time, and collect stats, once per step. workers take their
+    // delta_time from the last progressed frame, so systems here use SIM_DT
+    while (accumulator >= SIM_DT && steps < SIM_MAX_STEPS) {
+        ecs_run_pipeline(world, simPipeline, SIM_DT);
+        accumulator -= SIM_DT;
+        steps++;
+    }
+
+    if (steps == SIM_MAX_STEPS) accumulator = MIN(accumulator, SIM_DT);
+    return steps;
+}
+
+// how far between the last two steps rendering is, from 0 to 1
+f32 simAlpha(void) { return MIN(accumulator / SIM_DT, 1); }
+
+// count <= 0 uses one thread per online core
+void simSetThreads(ecs_world_t* world, i32 count) {
+    if (count <= 0) count = sysconf(_SC_NPROCESSORS_ONLN);
+    ecs_set_threads(world, MAX(1, count));
+}
+
+void SimModuleImport(ecs_world_t* world) {
+    ECS_MODULE(world, SimModule);
+    ECS_TAG_DEFINE(world, _fixedStep);
+    ECS_TAG_DEFINE(world, _frameStart);
+
+    startPipeline = createPipeline(world, "StartPipeline", EcsNot, EcsAnd);
+    simPipeline = createPipeline(world, "SimPipeline", EcsAnd, EcsNot);
+    framePipeline = createPipeline(world, "FramePipeline", EcsNot, EcsNot);
+    ecs_set_pipeline(world, framePipeline);
+    accumulator = 0;
+}
@@ -1,52 +1,74 @@
 #include "transform.h"
+#include "input.h"
+#include "integrate.h"
 #include "raylib.h"
+#include "sim.h"
+#include <string.h>
 
 ECS_COMPONENT_DECLARE(position_c);
 ECS_COMPONENT_DECLARE(velocity_c);
+ECS_COMPONENT_DECLARE(prevPosition_c);
+ECS_COMPONENT_DECLARE(acceleration_c);
+ECS_COMPONENT_DECLARE(drag_c);
 
 ECS_SYSTEM_DECLARE(Move);
 ECS_SYSTEM_DECLARE(Controller);
 ECS_TAG_DECLARE(_controllable);
 
+// acceleration and drag are optional, a table without them skips that work
 void Move(ecs_iter_t* it) {
     position_c* p = ecs_field(it, position_c, 0);
-    const velocity_c* v = ecs_field(it, velocity_c, 1);
+    velocity_c* v = ecs_field(it, velocity_c, 1);
+    prevPosition_c* prev = ecs_field(it, prevPosition_c, 2);
+    const acceleration_c* a = ecs_field(it, acceleration_c, 3);
+    const drag_c* d = ecs_field(it, drag_c, 4);
 
-    for (int i = 0; i < it->count; i++) {
-        p[i].x += v[i].x * GetFrameTime();
-        p[i].y += v[i].y * GetFrameTime();
-    }
+    memcpy(prev, p, sizeof(position_c) * it->count);
+    integrate((f32*)p, (f32*)v, (const f32*)a, (const f32*)d, it->count, SIM_DT);
 }
 
+// the keys are the same for every entity, so the direction is worked out once
 void Controller(ecs_iter_t* it) {
     velocity_c* v = ecs_field(it, velocity_c, 1);
+    const InputState* in = ecs_field(it, InputState, 2);
     f32 speed = 100;
 
+    velocity_c dir = {0, 0};
+    if (inputKeyDown(in, KEY_W)) dir.y -= speed;
+    if (inputKeyDown(in, KEY_S)) dir.y += speed;
+    if (inputKeyDown(in, KEY_A)) dir.x -= speed;
+    if (inputKeyDown(in, KEY_D)) dir.x += speed;
+
     for (int i = 0; i < it->count; i++) {
-        v[i].x = 0;
-        v[i].y = 0;
-        f32 delta = 1;
-
-        if (IsKeyDown(KEY_W)) {
-            v[i].y -= speed * delta;
-        }
-        if (IsKeyDown(KEY_S)) {
-            v[i].y += speed * delta;
-        }
-        if (IsKeyDown(KEY_A)) {
-            v[i].x -= speed * delta;
-        }
-        if (IsKeyDown(KEY_D)) {
-            v[i].x += speed * delta;
-        }
+        v[i] = dir;
     }
 }
 
 void TransformModuleImport(ecs_world_t* world) {
+    ECS_IMPORT(world, SimModule);
+    ECS_IMPORT(world, InputModule);
     ECS_MODULE(world, TransformModule);
     ECS_COMPONENT_DEFINE(world, position_c);
     ECS_COMPONENT_DEFINE(world, velocity_c);
-    ECS_SYSTEM_DEFINE(world, Move, EcsOnUpdate, position_c, velocity_c);
+    ECS_COMPONENT_DEFINE(world, prevPosition_c);
+    ECS_COMPONENT_DEFINE(world, acceleration_c);
+    ECS_COMPONENT_DEFINE(world, drag_c);
+
+    // anything that moves keeps where it was a step ago, to draw in between
+    ecs_add_pair(world, ecs_id(velocity_c), EcsWith, ecs_id(prevPosition_c));
+
+    // only touches its own components, so its entities are split over workers
+    ecs_id(Move) = ecs_system(
+        world,
+        {.entity = ecs_entity(world, {.name = "Move",
+                                      .add = ecs_ids(ecs_dependson(EcsOnUpdate))}),
+         .query.expr = "position_c, velocity_c, [out] prevPosition_c, "
+                       "[in] ?acceleration_c, [in] ?drag_c",
+         .callback = Move,
+         .multi_threaded = true});
     ECS_TAG_DEFINE(world, _controllable);
-    ECS_SYSTEM_DEFINE(world, Controller, EcsOnUpdate, _controllable, velocity_c);
+    ECS_SYSTEM_DEFINE(world, Controller, EcsOnUpdate, _controllable, velocity_c,
+                      [in] input.module.InputState($));
+    ecs_add(world, ecs_id(Move), _fixedStep);
+    ecs_add(world, ecs_id(Controller), _fixedStep);
 }
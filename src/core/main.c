@@ -1,19 +1,30 @@
+#include "carousel.h"
 #include "flecs.h"
+#include "input.h"
+#include "jobs.h"
 #include "planet.h"
+#include "profiler.h"
 #include "render.h"
+#include "replay.h"
+#include "sim.h"
 #include "state.h"
+#include "textCache.h"
 #include "transform.h"
 #include "uiFramework.h"
 #include "window.h"
 #include <raylib.h>
 #include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+// seeds the planet carousel; fixed so restarts come up from the disk cache
+#define UNIVERSE_SEED 0x5eedca11ull
 
 ecs_world_t* world;
 
-v2* mouse;
 f32 time;
 Font globalFont;
-const Planet* selectedPlanet_p;
+ecs_entity_t selectedPlanet_e;
 
 /* const u32 screenWidth = 480; */
 /* const u32 screenHeight = 270; */
@@ -21,15 +32,62 @@ const Planet* selectedPlanet_p;
 const u32 screenWidth = 640;
 const u32 screenHeight = 360;
 
-// TEST:
-Texture2D playerTex;
-void renderPlayer(ecs_entity_t e) {
-    const position_c* pos = ecs_get(world, e, position_c);
-    DrawTexture(playerTex, pos->x, pos->y, WHITE);
+typedef struct {
+    const char* record;        // log this session's input here
+    const char* replay;        // play this log back, in a hidden window
+    const char* trace;         // profile from the start, write a Chrome trace
+    const char* stats;         // profile from the start, write p50/p99 as csv
+    const char* planetBackend; // "gpu" draws planets with the shader backend
+} Args;
+
+static Args parseArgs(i32 argc, char** argv) {
+    Args a = {0};
+
+    for (i32 i = 1; i < argc; i += 2) {
+        const char** value;
+        if (!strcmp(argv[i], "--record")) {
+            value = &a.record;
+        } else if (!strcmp(argv[i], "--replay")) {
+            value = &a.replay;
+        } else if (!strcmp(argv[i], "--trace")) {
+            value = &a.trace;
+        } else if (!strcmp(argv[i], "--stats")) {
+            value = &a.stats;
+        } else if (!strcmp(argv[i], "--planet-backend")) {
+            value = &a.planetBackend;
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            exit(1);
+        }
+
+        if (i + 1 == argc) {
+            fprintf(stderr, "missing value for %s\n", argv[i]);
+            exit(1);
+        }
+        *value = argv[i + 1];
+    }
+
+    if (a.planetBackend != NULL && strcmp(a.planetBackend, "cpu") &&
+        strcmp(a.planetBackend, "gpu")) {
+        fprintf(stderr, "unknown planet backend %s, expected cpu or gpu\n",
+                a.planetBackend);
+        exit(1);
+    }
+    return a;
 }
 
-int main(void) {
-    setWindowFlags();
+int main(i32 argc, char** argv) {
+    Args args = parseArgs(argc, argv);
+    ReplaySeeds seeds = {.universeSeed = UNIVERSE_SEED};
+    if (args.replay != NULL && !replayPlay(args.replay, &seeds)) return 1;
+
+    setWindowFlags(args.replay != NULL);
+    // raylib seeds itself from the clock when the window opens; drawing the
+    // session's seed from that keeps it random but lets a recording restore it
+    if (args.replay == NULL) seeds.randomSeed = GetRandomValue(0, INT32_MAX);
+    SetRandomSeed(seeds.randomSeed);
+    if (args.record != NULL && !replayRecord(args.record, seeds)) return 1;
+
     RenderTexture2D target = LoadRenderTexture(screenWidth, screenHeight);
     SetTextureFilter(target.texture, TEXTURE_FILTER_POINT);
 
@@ -37,14 +95,31 @@ int main(void) {
 
     planetTest();
 
+    // planet generation and the sim's workers split the cores, rather than
+    // each starting one thread per core
+    i32 cores = MAX(1, sysconf(_SC_NPROCESSORS_ONLN));
+    jobsInit(MAX(1, cores / 2));
     world = ecs_init();
+#ifdef ECS_EXPLORER
+    // per-system timings, archetypes and tables live in the flecs explorer,
+    // https://www.flecs.dev/explorer connects to the REST server on localhost
+    ECS_IMPORT(world, FlecsStats);
+    ecs_measure_system_time(world, true);
+    ecs_singleton_set(world, EcsRest, {.ipaddr = "127.0.0.1"});
+#endif
+    ECS_IMPORT(world, SimModule);
+    ECS_IMPORT(world, InputModule);
     ECS_IMPORT(world, TransformModule);
     ECS_IMPORT(world, RendererModule);
+    renderSetTarget(target);
+    planetPreferGPU(args.planetBackend != NULL &&
+                    !strcmp(args.planetBackend, "gpu"));
     ECS_IMPORT(world, PlanetModule);
     ECS_IMPORT(world, UIModule);
-    playerTex = LoadTexture("assets/images/player/playerDown.png");
+    simSetThreads(world, MAX(1, cores - cores / 2)); // the main thread included
+    if (args.trace != NULL) profilerTrace();
+    profilerEnable(world, args.trace != NULL || args.stats != NULL);
 
-    mouse = malloc(sizeof(v2));
     Texture2D background = genCosmicBackground();
 
     textbox_e testBox =
@@ -56,54 +131,91 @@ int main(void) {
     TextboxPush(testBox, "ATMOSPHERE", 16, LoadTexture(pthSm));
     TextboxPush(testBox, "TERRAIN", 16, LoadTexture(pthSm));
 
-    ecs_entity_t testContainer = createPlanetContainer(2);
-    bool done = true;
-    bool lastDir = false;
+    ecs_entity_t testContainer = createPlanetContainer(2, seeds.universeSeed);
     Texture2D lastText;
 
+    f64 runStart = GetTime();
+    f64 worstFrame = 0;
+    u64 frames = 0;
+
     while (!WindowShouldClose()) {
-        f32 scale = getWindowScale();
-        *mouse = getScreenMousePos(mouse, scale, screenWidth, screenHeight);
+        f64 frameStart = GetTime();
+        simBeginFrame(world);
+        if (replayFinished()) break;
+        const InputState* in = ecs_singleton_get(world, InputState);
 
-        if (IsMouseButtonDown(MOUSE_BUTTON_MIDDLE)) {
-            printf("pressed middle mouse button\n");
-        }
+        const Planet* selected =
+            selectedPlanet_e ? ecs_get(world, selectedPlanet_e, Planet) : NULL;
 
-        BeginTextureMode(target);
-        ClearBackground(BLACK);
+        Texture2D selectedBg =
+            selected ? planetBackground(selected) : (Texture2D){0};
 
-        if (selectedPlanet_p == NULL) {
-            DrawTextureEx(background, (v2){0, 0}, 0, 1, WHITE);
+        if (selectedBg.id == 0) {
+            renderTexture(RENDER_BACKGROUND_LAYER, background, (v2){0, 0}, 1,
+                          WHITE);
         } else {
-            if (lastText.id != selectedPlanet_p->background.id) {
+            if (lastText.id != selectedBg.id) {
                 printf("changed\n");
             }
-            DrawTextureEx(selectedPlanet_p->background, (v2){0, 0}, 0, 1, WHITE);
-            lastText = selectedPlanet_p->background;
+            renderTexture(RENDER_BACKGROUND_LAYER, selectedBg, (v2){0, 0}, 1,
+                          WHITE);
+            lastText = selectedBg;
         }
 
-        ecs_progress(world, GetFrameTime());
-        time += GetFrameTime();
+        ProfileScope scope = profileBegin("sim steps");
+        simAdvance(world, in->frameTime);
+        profileEnd(scope);
+
+        scope = profileBegin("frame systems");
+        ecs_progress(world, in->frameTime);
+        profileEnd(scope);
+        time += in->frameTime;
 
-        if (IsKeyPressed(KEY_RIGHT) && done) {
-            scrollPlanet(testContainer, false, true, &done);
-            lastDir = false;
-        } else if (IsKeyPressed(KEY_LEFT) && done) {
-            scrollPlanet(testContainer, true, true, &done);
-            lastDir = true;
+        if (inputButtonDown(in, MOUSE_BUTTON_MIDDLE)) {
+            printf("pressed middle mouse button\n");
         }
 
-        if (!done) {
-            scrollPlanet(testContainer, lastDir, false, &done);
+        if (inputKeyPressed(in, KEY_RIGHT)) {
+            carouselScroll(testContainer, 1);
+        } else if (inputKeyPressed(in, KEY_LEFT)) {
+            carouselScroll(testContainer, -1);
         }
 
-        EndTextureMode();
+        // F3 shows the profiler
+        if (inputKeyPressed(in, KEY_F3)) profilerEnable(world, !profilerOn);
+
         BeginDrawing();
         ClearBackground(BLACK);
-        drawScaledWindow(target, screenWidth, screenHeight, scale);
+        scope = profileBegin("blit");
+        drawScaledWindow(target, screenWidth, screenHeight, getWindowScale());
+        profileEnd(scope);
+        profilerDrawOverlay();
+
+        scope = profileBegin("present");
         EndDrawing();
+        profileEnd(scope);
+        profilerEndFrame(world);
+
+        frames++;
+        worstFrame = MAX(worstFrame, GetTime() - frameStart);
     }
 
+    if (args.replay != NULL) {
+        f64 total = GetTime() - runStart;
+        printf("replay: %llu frames in %.3f s, mean %.3f ms, worst %.3f ms\n",
+               (unsigned long long)frames, total, total * 1000 / MAX(frames, 1),
+               worstFrame * 1000);
+    }
+    replayClose();
+    if (args.trace != NULL) profilerWriteTrace(args.trace);
+    if (args.stats != NULL) profilerWriteCsv(args.stats);
+    profilerShutdown();
+
+    jobsShutdown();
+    unloadPlanetBackgrounds();
+    textCacheClear();
+    unloadPendingPlanets();
+    planetBackend->shutdown();
     CloseWindow();
 
     return 0;
@@ -4,16 +4,23 @@
 #include "render.h"
 #include "state.h"
 #include "transform.h"
+#include <math.h>
 
 ECS_COMPONENT_DECLARE(label_c);
 
+// a textbox and its labels are drawn once into panel and shown as a Sprite;
+// the panel is redrawn when a label is pushed or the box moves
 typedef struct {
     usize size;
     i32 maxLen;
     i32 minLen;
     v2 endCon;
+    bool dirty;
+    v2 bakedAt; // the box's position when the panel was drawn
+    RenderTexture2D panel;
 } textbox_c;
 ECS_COMPONENT_DECLARE(textbox_c);
+ECS_SYSTEM_DECLARE(DrawPanels);
 
 void drawConnectiveLine(const v2 start, const v2 end) {
     const v2 dist = (v2){end.x - start.x, end.y - start.y};
@@ -26,42 +33,123 @@ void drawConnectiveLine(const v2 start, const v2 end) {
     DrawLineEx((v2){start.x + dist.x / 2, end.y}, (v2){end.x, end.y}, width, cl);
 }
 
-void renderLabel(ecs_entity_t e) {
-    const label_c* l = ecs_get(world, e, label_c);
-    const position_c* pos = ecs_get(world, e, position_c);
+// draws the label relative to the panel's origin
+void drawLabel(const label_c* l, v2 at) {
     i32 iconOffset = 0;
 
     if ((l->icon.width != 0)) {
-        DrawTexture(l->icon, pos->x + l->offset.x,
-                    pos->y + l->offset.y - l->icon.height / 2.0, WHITE);
+        DrawTexture(l->icon, at.x + l->offset.x,
+                    at.y + l->offset.y - l->icon.height / 2.0, WHITE);
         iconOffset = l->icon.width * 1.2f;
     }
 
-    i32 yoff = MeasureTextEx(globalFont, l->text, l->fontSize, 1).y / 2;
+    if (l->run == NULL) return;
+    i32 yoff = l->run->extent.y / 2;
 
-    DrawTextEx(globalFont, l->text,
-               (v2){pos->x + l->offset.x + iconOffset, pos->y + l->offset.y - yoff},
-               l->fontSize, 1, WHITE);
+    drawTextRun(l->run,
+                (v2){at.x + l->offset.x + iconOffset, at.y + l->offset.y - yoff},
+                WHITE);
 }
-void renderTextbox(ecs_entity_t e) {
-    const position_c* pos = ecs_get(world, e, position_c);
-    const textbox_c* box = ecs_get(world, e, textbox_c);
 
-    const f32 width = MAX(box->maxLen, box->minLen);
+// the box and its connector, in the box's own space
+Rect panelBounds(const textbox_c* box, const position_c* pos) {
+    Rect r = {0, 0, MAX(box->maxLen, box->minLen), 20 * box->size};
 
-    DrawRectangleRounded((Rect){pos->x, pos->y, width, 20 * box->size}, 0.3, 2,
-                         GRUV_DARK2);
+    if (box->endCon.x != -1) {
+        v2 end = {box->endCon.x - pos->x, box->endCon.y - pos->y};
+        f32 x0 = MIN(r.x, MIN(box->maxLen, end.x));
+        f32 y0 = MIN(r.y, MIN(20, end.y));
+        f32 x1 = MAX(r.width, MAX(box->maxLen, end.x) + 1);
+        f32 y1 = MAX(r.height, MAX(20, end.y) + 1);
+        r = (Rect){x0, y0, x1 - x0, y1 - y0};
+    }
+
+    return (Rect){floorf(r.x), floorf(r.y), ceilf(r.width), ceilf(r.height)};
+}
+
+void drawPanel(ecs_entity_t e, textbox_c* box, const position_c* pos,
+               Sprite* sprite) {
+    const Rect bounds = panelBounds(box, pos);
+
+    if (box->panel.texture.width != bounds.width ||
+        box->panel.texture.height != bounds.height) {
+        if (box->panel.id != 0) UnloadRenderTexture(box->panel);
+        box->panel = LoadRenderTexture(bounds.width, bounds.height);
+    }
+
+    const v2 origin = {-bounds.x, -bounds.y};
+
+    BeginTextureMode(box->panel);
+    ClearBackground(BLANK);
+    DrawRectangleRounded((Rect){origin.x, origin.y, MAX(box->maxLen, box->minLen),
+                                20 * box->size},
+                         0.3, 2, GRUV_DARK2);
 
     if (box->endCon.x != -1) {
-        drawConnectiveLine((v2){pos->x + box->maxLen, pos->y + 20}, box->endCon);
+        drawConnectiveLine((v2){origin.x + box->maxLen, origin.y + 20},
+                           (v2){origin.x + box->endCon.x - pos->x,
+                                origin.y + box->endCon.y - pos->y});
+    }
+
+    ecs_iter_t it = ecs_children(world, e);
+    while (ecs_children_next(&it)) {
+        for (int i = 0; i < it.count; i++) {
+            const label_c* l = ecs_get(world, it.entities[i], label_c);
+            const position_c* lpos = ecs_get(world, it.entities[i], position_c);
+            if (l == NULL || lpos == NULL) continue;
+
+            drawLabel(l, (v2){origin.x + lpos->x - pos->x,
+                              origin.y + lpos->y - pos->y});
+        }
+    }
+    EndTextureMode();
+
+    // render textures are stored upside down. written in place, not through a
+    // deferred set, since the old panel is already unloaded
+    *sprite = spriteOf(box->panel.texture, TEXTBOX_LAYER);
+    sprite->src.height = -sprite->src.height;
+    sprite->offset = (v2){bounds.x, bounds.y};
+
+    box->bakedAt = (v2){pos->x, pos->y};
+    box->dirty = false;
+}
+
+// runs before RenderSubmit binds the frame's target, so panels can be drawn;
+// PostUpdate so the Sprite is in place by the time DrawSprites runs
+void DrawPanels(ecs_iter_t* it) {
+    const position_c* pos = ecs_field(it, position_c, 0);
+    textbox_c* box = ecs_field(it, textbox_c, 1);
+    Sprite* sprite = ecs_field(it, Sprite, 2);
+
+    for (int i = 0; i < it->count; i++) {
+        if (box[i].bakedAt.x != pos[i].x || box[i].bakedAt.y != pos[i].y) {
+            box[i].dirty = true;
+        }
+        if (box[i].dirty) {
+            drawPanel(it->entities[i], &box[i], &pos[i], &sprite[i]);
+        }
     }
 }
+
+void PanelRemoved(ecs_iter_t* it) {
+    textbox_c* box = ecs_field(it, textbox_c, 0);
+
+    for (int i = 0; i < it->count; i++) {
+        if (box[i].panel.id != 0) UnloadRenderTexture(box[i].panel);
+    }
+}
+
 textbox_e createTextbox(const char* title, v2 pos, v2 connectionPoint) {
     textbox_e e = ecs_new(world);
     ecs_set(world, e, position_c, {pos.x, pos.y});
-    ecs_set(world, e, Renderable, {5, renderTextbox});
     ecs_set(world, e, textbox_c,
-            {.size = 0, .maxLen = 0, .minLen = 100, .endCon = connectionPoint});
+            {.size = 0,
+             .maxLen = 0,
+             .minLen = 100,
+             .endCon = connectionPoint,
+             .dirty = true});
+    // blank until DrawPanels draws the panel into it
+    ecs_set(world, e, Sprite, {.layer = TEXTBOX_LAYER});
 
     TextboxPush(e, title, 20, (Texture2D){});
     TextboxPush(e, "", 20, (Texture2D){});
@@ -71,10 +159,11 @@ textbox_e createTextbox(const char* title, v2 pos, v2 connectionPoint) {
 ecs_entity_t TextboxPush(textbox_e e, const char* text, f32 fontSize,
                          Texture2D icon) {
     const position_c* boxPos = ecs_get(world, e, position_c);
-    u32 priority = ecs_get(world, e, Renderable)->renderLayer + 1;
     textbox_c* box = ecs_get_mut(world, e, textbox_c);
 
-    const v2 measure = MeasureTextEx(globalFont, text, fontSize, 1);
+    // laid out once here; the label never changes after it is pushed
+    const TextRun* run = textRunBaked(globalFont, text, fontSize, 1);
+    const v2 measure = run ? run->extent : (v2){0};
 
     const i16 padx = 5;
     i32 pady = measure.y / 1.7;
@@ -87,17 +176,27 @@ ecs_entity_t TextboxPush(textbox_e e, const char* text, f32 fontSize,
             {.text = text,
              .offset = {padx, pady + 5},
              .icon = icon,
-             .fontSize = fontSize});
+             .fontSize = fontSize,
+             .run = run});
     ecs_set(world, label, position_c,
             {boxPos->x, boxPos->y + (pady * 2 * box->size)});
-    ecs_set(world, label, Renderable, {priority, renderLabel});
     ++box->size;
+    box->dirty = true;
 
     return label;
 }
 
 void UIModuleImport(ecs_world_t* world) {
+    ECS_IMPORT(world, TransformModule);
+    ECS_IMPORT(world, RendererModule);
     ECS_MODULE(world, UIModule);
     ECS_COMPONENT_DEFINE(world, label_c);
     ECS_COMPONENT_DEFINE(world, textbox_c);
+
+    ECS_SYSTEM_DEFINE(world, DrawPanels, EcsPostUpdate,
+                      [in] transform.module.position_c, textbox_c,
+                      [inout] renderer.module.Sprite);
+    ecs_observer(world, {.query.terms = {{.id = ecs_id(textbox_c)}},
+                         .events = {EcsOnRemove},
+                         .callback = PanelRemoved});
 }
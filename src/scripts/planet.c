@@ -1,545 +1,387 @@
 #include "planet.h"
+#include "carousel.h"
+#include "input.h"
+#include "jobs.h"
+#include "planetBackend.h"
+#include "planetCache.h"
+#include "profiler.h"
 #include "raylib.h"
 #include "render.h"
+#include "sim.h"
+#include "spatialGrid.h"
 #include "state.h"
 #include "transform.h"
-#include <assert.h>
 #include <math.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <time.h>
 
-#define DARKEN(c, f) ((Color){(c.r * f), (c.g * f), (c.b * f), (c.a)})
-#define DIST(x1, y1, x2, y2) (sqrtf(powf(x1 - x2, 2) + powf(y1 - y2, 2)))
-#define PLANET_NAMES_PATH "assets/planet_names.txt"
-#define ABS(x) ((x) < 0 ? -(x) : (x))
-
 ECS_COMPONENT_DECLARE(Planet);
-ECS_TAG_DECLARE(_scrollablePlanet);
 ECS_COMPONENT_DECLARE(Clickable);
+ECS_COMPONENT_DECLARE(PlanetPending);
+ECS_TAG_DECLARE(_hovered);
 ECS_SYSTEM_DECLARE(HandleClickables);
+ECS_SYSTEM_DECLARE(SyncClickables);
+ECS_SYSTEM_DECLARE(StreamPlanets);
+ECS_SYSTEM_DECLARE(DrawPlanets);
 
-Shader planetBloom;
-
-f32 lerp(f32 a, f32 b, f32 t) { return a + t * (b - a); }
-
-ColorRamp createColorRampAuto(Color* colors, usize len, i32 max) {
-    i32 step = max / len;
-    ColorRamp r;
+// hitboxes of every enabled clickable, kept up to date by SyncClickables
+static SpatialGrid* clickableGrid;
+static ecs_entity_t hovered[CLICKABLE_MAX_HOVERED];
+static usize hoveredLen = 0;
 
-    for (usize i = 0; i < len - 1; i++) {
-        r.steps[i] = (i + 1) * step;
-    }
-    for (usize i = 0; i < len; i++) {
-        r.colors[i] = colors[i];
-    }
-    r.steps[len - 1] = max;
-    r.len = len;
-    return r;
-}
+// set by PlanetModuleImport; the CPU backend until then
+const PlanetBackend* planetBackend = &planetBackendCPU;
+static bool preferGPU = false;
 
-ColorRamp createColorRamp(i32* steps, Color* colors, usize len) {
-    ColorRamp r;
-    for (usize i = 0; i < len; i++) {
-        r.steps[i] = steps[i];
-        r.colors[i] = colors[i];
+void drawColorRamp(u32 layer, const ColorRamp* ramp) {
+    for (usize i = 0; i < ramp->len; i++) {
+        Color c = ramp->colors[i];
+        renderRect(layer, (Rect){i * 10 + 10, 0, 10, 10}, c);
     }
-    r.len = len;
-    return r;
-}
 
-// Function to interpolate between colors in the ColorRamp
-Color getColorFromRamp(float t, ColorRamp ramp) {
-    for (usize i = 0; i < ramp.len - 1; i++) {
-        if (t <= ramp.steps[i]) return ramp.colors[i];
-    }
-    return ramp.colors[ramp.len - 1];
+    renderRect(layer, (Rect){0, 10, 10, 10}, averageRamp(ramp));
 }
 
-Image averageImages(Image m1, Image m2) {
-    assert(m1.width == m2.width && m1.height == m2.height &&
-           "Images must be the same size");
-
-    Image ret = GenImageColor(m1.width, m1.height, BLANK);
-    Color* p1 = LoadImageColors(m1);
-    Color* p2 = LoadImageColors(m2);
-
-    for (usize i = 0; i < (usize)(m1.width * m1.height); i++) {
-        i32 x = i % m1.width;
-        i32 y = i / m1.width;
-
-        Color c1 = p1[i];
-        Color c2 = p2[i];
+void drawPlanetName(u32 layer, const Color avg, const v2* pos, const char* name,
+                    f32 scale) {
+    const i32 spacing = 1;
+    const TextRun* run = textRun(globalFont, name, PLANET_NAME_SIZE, spacing);
+    if (run == NULL) return;
 
-        Color c = (Color){(c1.r + c2.r) / 2, (c1.g + c2.g) / 2, (c1.b + c2.b) / 2,
-                          (c1.a + c2.a) / 2};
+    i32 len = run->extent.x;
+    v2 center = {pos->x + PLANET_RES * scale / 2.0,
+                 pos->y + PLANET_RES * scale / 2.0};
+    v2 textPos = {center.x - len / 2.0, center.y - PLANET_RES * scale / 2.0 - 30};
 
-        ImageDrawPixel(&ret, x, y, c);
-    }
+    renderTextRun(layer, run, textPos, avg);
+}
 
-    UnloadImageColors(p1);
-    UnloadImageColors(p2);
-    return ret;
+// drawn while the planet's images are still being generated
+void planetPlaceholderRender(u32 layer, const Planet* p, const position_c* pos) {
+    v2 center = {pos->x + PLANET_RES * p->scale / 2.0,
+                 pos->y + PLANET_RES * p->scale / 2.0};
+    renderCircleLines(layer, center, PLANET_RES * p->scale / 2, GRUV_DARK3);
 }
 
-Image cropToCircle(Image img) {
-    Color* p = LoadImageColors(img);
-    Image ret = GenImageColor(img.width, img.height, BLANK);
+// land, atmosphere and the overlays each get their own layer, since the queue
+// only keeps their order within a layer when they share a texture
+void planetRender(u32 layer, const Planet* p, const position_c* pos,
+                  bool hovered) {
+    if (p->land.id == 0) {
+        planetPlaceholderRender(layer + 2, p, pos);
+        return;
+    }
 
-    i32 circle = img.width / 2;
+    renderTexture(layer, p->land, (v2){pos->x, pos->y}, p->scale, WHITE);
+    renderTexture(layer + 1, p->atmosphere,
+                  (v2){pos->x - p->atmosphereOffset * (p->scale / 2.0),
+                       pos->y - p->atmosphereOffset * (p->scale / 2.0)},
+                  p->scale, WHITE);
 
-    for (usize i = 0; i < (usize)(img.width * img.height); i++) {
-        i32 x = i % img.width;
-        i32 y = i / img.width;
+    drawColorRamp(layer + 2, &p->palette);
+    drawPlanetName(layer + 2, p->avg, &(v2){pos->x, pos->y}, p->name, p->scale);
 
-        if (sqrtf(powf(x - circle, 2) + powf(y - circle, 2)) < circle) {
-            ImageDrawPixel(&ret, x, y, p[i]);
-        }
+    if (hovered) {
+        v2 center = {pos->x + PLANET_RES * p->scale / 2.0,
+                     pos->y + PLANET_RES * p->scale / 2.0};
+        f32 rad = (PLANET_RES * ATMOSPHERE_SCALE * p->scale) / 2 + 1;
+        renderCircleLines(layer + 2, center, rad, GRUV_BLUE);
     }
-
-    UnloadImageColors(p);
-    return ret;
 }
 
-Image dither(i32 circleOffsetx, i32 circleOffsety, Image m) {
-    assert(m.width == m.height && "Image must be square");
-
-    // darken pixels the futher they are from the shadow circle
-    Image ret = GenImageColor(m.width, m.height, BLANK);
-    Color* p = LoadImageColors(m);
-
-    i32 cx = m.width / 2 + circleOffsetx;
-    i32 cy = m.height / 2 + circleOffsety;
-
-    for (usize i = 0; i < (usize)(m.width * m.height); i++) {
-        i32 x = i % m.width;
-        i32 y = i / m.width;
-
-        i32 d = DIST(x, y, cx, cy) / 1.05;
-        f32 f = 1 - (d / (f32)((f32)m.width / 2));
-        f = f < 0 ? 0 : f;
-
-        ImageDrawPixel(&ret, x, y, DARKEN(p[i], f));
+// planets in a carousel are moved on fixed steps, so they are drawn between
+// the last two like sprites are
+void DrawPlanets(ecs_iter_t* it) {
+    const Planet* p = ecs_field(it, Planet, 0);
+    const position_c* pos = ecs_field(it, position_c, 1);
+    bool hovered = ecs_field_is_set(it, 2);
+    const prevPosition_c* prev = ecs_field(it, prevPosition_c, 3);
+    const f32 alpha = simAlpha();
+
+    for (int i = 0; i < it->count; i++) {
+        position_c at = pos[i];
+        if (prev != NULL) {
+            at.x = prev[i].x + (at.x - prev[i].x) * alpha;
+            at.y = prev[i].y + (at.y - prev[i].y) * alpha;
+        }
+        planetRender(PLANET_RENDER_LAYER, &p[i], &at, hovered);
     }
-
-    UnloadImageColors(p);
-    return ret;
 }
 
-Color HSVtoRGB(i32 h, i32 s, i32 v) {
-    f32 r, g, b;
-    f32 f, p, q, t;
+void onPlanetHover(ecs_entity_t e) { ecs_add(world, e, _hovered); }
 
-    f32 S = s / 100.0;
-    f32 V = v / 100.0;
+void onPlanetExitHover(ecs_entity_t e) { ecs_remove(world, e, _hovered); }
 
-    if (s == 0) {
-        r = g = b = V;
-    } else {
-        f = (h % 60) / 60.0;
-        p = V * (1 - S);
-        q = V * (1 - S * f);
-        t = V * (1 - S * (1 - f));
-
-        switch (h / 60) {
-        case 0:
-            r = V;
-            g = t;
-            b = p;
-            break;
-        case 1:
-            r = q;
-            g = V;
-            b = p;
-            break;
-        case 2:
-            r = p;
-            g = V;
-            b = t;
-            break;
-        case 3:
-            r = p;
-            g = q;
-            b = V;
-            break;
-        case 4:
-            r = t;
-            g = p;
-            b = V;
-            break;
-        case 5:
-            r = V;
-            g = p;
-            b = q;
-            break;
+void onPlanetClick(ecs_entity_t e) {
+    const Planet* p = ecs_get(world, e, Planet);
+    if (p->land.id == 0) return; // still streaming in
+
+    printf("Clicked on planet %s which is entity %ld \n", p->name, e);
+    selectedPlanet_e = e;
+}
+
+// a background is only shown for the selected planet, so they are generated on
+// selection and at most PLANET_BACKGROUNDS_RESIDENT are kept on the GPU
+typedef struct {
+    u64 seed;
+    Texture2D tex;
+    u64 lastUsed;
+} BackgroundSlot;
+
+typedef struct {
+    u64 seed;
+    ColorRamp palette;
+    Image img;
+    atomic_bool ready;
+} BackgroundJob;
+
+static BackgroundSlot backgrounds[PLANET_BACKGROUNDS_RESIDENT];
+static BackgroundJob* backgroundJob = NULL;
+static u64 backgroundClock = 0;
+
+static void backgroundJobRun(void* arg) {
+    BackgroundJob* job = arg;
+    job->img = generatePlanetBackground(job->palette, job->seed);
+    atomic_store(&job->ready, true);
+}
+
+static BackgroundSlot* findBackground(u64 seed) {
+    for (i32 i = 0; i < PLANET_BACKGROUNDS_RESIDENT; i++) {
+        if (backgrounds[i].tex.id != 0 && backgrounds[i].seed == seed) {
+            return &backgrounds[i];
         }
     }
-
-    return (Color){(u8)(r * 255), (u8)(g * 255), (u8)(b * 255), 255};
+    return NULL;
 }
 
-void RGBtoHSV(Color c, i32* h, i32* s, i32* v) {
-    f32 r = c.r / 255.0;
-    f32 g = c.g / 255.0;
-    f32 b = c.b / 255.0;
-
-    f32 max = fmax(r, fmax(g, b));
-    f32 min = fmin(r, fmin(g, b));
-    f32 d = max - min;
-
-    if (d == 0) {
-        *h = 0;
-    } else if (max == r) {
-        *h = 60 * fmod((g - b) / d, 6);
-        if (*h < 0) *h += 360;
-    } else if (max == g) {
-        *h = 60 * ((b - r) / d + 2);
-    } else if (max == b) {
-        *h = 60 * ((r - g) / d + 4);
+// an empty slot if there is one, otherwise the least recently used
+static BackgroundSlot* evictBackground(void) {
+    BackgroundSlot* victim = &backgrounds[0];
+    for (i32 i = 0; i < PLANET_BACKGROUNDS_RESIDENT; i++) {
+        if (backgrounds[i].tex.id == 0) return &backgrounds[i];
+        if (backgrounds[i].lastUsed < victim->lastUsed) victim = &backgrounds[i];
     }
 
-    *s = (max == 0) ? 0 : (d / max) * 100;
-    *v = max * 100;
+    UnloadTexture(victim->tex);
+    victim->tex = (Texture2D){0};
+    return victim;
 }
 
-Color* generateHarmonizedColors(Color baseColor, i32 colorCount, i32 hueShift,
-                                float saturationFactor, float brightnessFactor) {
-    Color* colors = (Color*)malloc(sizeof(Color) * colorCount);
-    i32 hue, saturation, brightness;
-
-    // Convert the base color to HSV
-    RGBtoHSV(baseColor, &hue, &saturation, &brightness);
+// uploads the finished background job, if any. render thread only
+static void collectBackground(void) {
+    if (backgroundJob == NULL || !atomic_load(&backgroundJob->ready)) return;
 
-    // Generate colors by adjusting the hue, saturation, and brightness
-    for (i32 i = 0; i < colorCount; i++) {
-        i32 newHue = (hue + i * hueShift) % 360;
-        i32 newSaturation = (int)(saturation * saturationFactor);
-        i32 newBrightness = (int)(brightness * brightnessFactor);
+    BackgroundSlot* slot = evictBackground();
+    slot->seed = backgroundJob->seed;
+    slot->tex = LoadTextureFromImage(backgroundJob->img);
+    slot->lastUsed = ++backgroundClock;
 
-        // Store the new color in the array
-        colors[i] = HSVtoRGB(newHue, newSaturation, newBrightness);
-    }
-
-    return colors;
+    UnloadImage(backgroundJob->img);
+    free(backgroundJob);
+    backgroundJob = NULL;
 }
 
 /**
- * Generates a Perlin noise-based image with colors applied from a
- * ColorRamp.
- *
- * @param res          The resolution of the generated image (width and
- * height).
- * @param ramp         The ColorRamp to use for coloring the Perlin noise.
- * @param customScale  The scale for Perlin noise; set to -1 to use the
- * default scale.
- *
- * @return An Image object generated based on the provided resolution, color
- * ramp, and scale.
+ * Returns p's background, generating it on a worker the first time it is asked
+ * for. Until that finishes the returned texture has id 0. Render thread only.
  */
-Image colorPerlin(enum NoiseType type, usize res, ColorRamp ramp, f32 customScale) {
-    i32 s = GetRandomValue(-100, 100);
-    i32 s2 = GetRandomValue(-100, 100);
-
-    f32 scaleBase = 5;
-    scaleBase += GetRandomValue(-250, 500) / 100.0;
+Texture2D planetBackground(const Planet* p) {
+    collectBackground();
 
-    if (customScale != -1) {
-        scaleBase = customScale;
+    BackgroundSlot* slot = findBackground(p->seed);
+    if (slot != NULL) {
+        slot->lastUsed = ++backgroundClock;
+        return slot->tex;
     }
 
-    Image noise1, noise2;
+    // one generation in flight; a newer request is picked up next frame
+    if (backgroundJob == NULL && p->land.id != 0) {
+        backgroundJob = malloc(sizeof(BackgroundJob));
+        if (backgroundJob == NULL) {
+            perror("Error allocating memory in planetBackground");
+            return (Texture2D){0};
+        }
 
-    if (type == PERLIN) {
-        noise1 = GenImagePerlinNoise(res, res, s, s * 2, scaleBase);
-        noise2 = GenImagePerlinNoise(res, res, s2, s2 * 2, scaleBase * 2);
-    } else {
-        noise1 = GenImageCellular(res, res, scaleBase);
-        noise2 = GenImageCellular(res, res, scaleBase * 2);
+        backgroundJob->seed = p->seed;
+        backgroundJob->palette = p->palette;
+        atomic_init(&backgroundJob->ready, false);
+        jobsSubmit(backgroundJobRun, backgroundJob);
     }
-    Image noise = averageImages(noise1, noise2);
-
-    Color* noiseCl = LoadImageColors(noise);
-    Image buf1 = GenImageColor(res, res, BLANK);
 
-    for (usize i = 0; i < res * res; i++) {
-        i32 x = i % res;
-        i32 y = i / res;
+    return (Texture2D){0};
+}
 
-        ImageDrawPixel(&buf1, x, y, getColorFromRamp(noiseCl[i].r, ramp));
+void unloadPlanetBackgrounds(void) {
+    if (backgroundJob != NULL) {
+        jobsWait();
+        collectBackground();
+        // still set if jobsShutdown dropped it before it ran
+        free(backgroundJob);
+        backgroundJob = NULL;
     }
 
-    UnloadImage(noise1);
-    UnloadImage(noise2);
-    UnloadImageColors(noiseCl);
-    return buf1;
-}
-
-void printTestRes(const char* txt, bool passed) {
-    // use ansi escape codes to color the output
-    if (passed) {
-        printf("\033[1;32m[PASSED]");
-        printf("\033[0m");
-        printf(" -- %s\n", txt);
-    } else {
-        printf("\033[1;31m[FAILED]");
-        printf("\033[0m");
-        printf(" -- %s\n", txt);
+    for (i32 i = 0; i < PLANET_BACKGROUNDS_RESIDENT; i++) {
+        if (backgrounds[i].tex.id != 0) UnloadTexture(backgrounds[i].tex);
+        backgrounds[i] = (BackgroundSlot){0};
     }
 }
 
-Color averageRamp(const ColorRamp* ramp) {
-    i32 rs = 0;
-    i32 gs = 0;
-    i32 bs = 0;
-
-    for (usize i = 0; i < ramp->len; i++) {
-        Color c = ramp->colors[i];
-        rs += c.r;
-        gs += c.g;
-        bs += c.b;
-    }
+/**
+ * Frees the jobs of planets still streaming in. jobsShutdown drops jobs that
+ * never started, so this runs after it: by then no worker holds a job, and
+ * the finished ones still own their images.
+ */
+void unloadPendingPlanets(void) {
+    ecs_iter_t it = ecs_each(world, PlanetPending);
+    while (ecs_each_next(&it)) {
+        PlanetPending* pending = ecs_field(&it, PlanetPending, 0);
 
-    return (Color){rs / ramp->len, gs / ramp->len, bs / ramp->len, 255};
-}
+        for (i32 i = 0; i < it.count; i++) {
+            PlanetJob* job = pending[i].job;
+            if (job == NULL) continue;
 
-void drawColorRamp(const ColorRamp* ramp) {
-    for (usize i = 0; i < ramp->len; i++) {
-        Color c = ramp->colors[i];
-        DrawRectangle(i * 10 + 10, 0, 10, 10, c);
+            if (atomic_load(&job->ready)) unloadPlanetImages(&job->imgs);
+            free(job);
+            pending[i].job = NULL;
+        }
     }
-
-    DrawRectangle(0, 10, 10, 10, averageRamp(ramp));
 }
 
-void planetTest() {
-    printf("\033[1;33m--------[RUNNING TESTS]--------]\n");
-    Color a = RED;
-    i32 h, s, v;
-    RGBtoHSV(a, &h, &s, &v);
-    Color b = HSVtoRGB(h, s, v);
+// creates a planet with no textures yet; DrawPlanets shows a placeholder
+ecs_entity_t spawnPlanetPending(v2 pos, f32 scale, u64 seed) {
+    i32 atmosphereOffset = (PLANET_RES * ATMOSPHERE_SCALE - PLANET_RES);
 
-    bool passed =
-        (abs(a.r - b.r) < 5) && (abs(a.g - b.g) < 5) && (abs(a.b - b.b) < 5);
+    ecs_entity_t e = ecs_new(world);
+    ecs_set(world, e, Planet,
+            {.atmosphereOffset = atmosphereOffset,
+             .scale = scale,
+             .seed = seed});
+    ecs_set(world, e, position_c, {pos.x, pos.y});
+    // clang-format off
+    ecs_set(world, e, Clickable, {onPlanetClick, onPlanetHover, onPlanetExitHover,{PLANET_RES * scale, PLANET_RES * scale}});
+    // clang-format on
 
-    printTestRes("RGB to HSV to RGB", passed);
+    return e;
 }
 
-Color brightenColor(Color c) {
-    i32 max = fmax(c.r, fmax(c.g, c.b));
-    i32 diff = 255 - max;
-    return (Color){c.r + diff, c.g + diff, c.b + diff, c.a};
+// what a worker can prepare for seed. backends that can't run off the render
+// thread only get the description; their layers are drawn in uploadPlanet
+void preparePlanetImages(PlanetImages* imgs, u64 seed) {
+    if (planetBackend->threaded) {
+        loadOrGeneratePlanetImages(imgs, seed);
+    } else if (!planetCacheLoad(imgs, seed)) {
+        // a miss is drawn on the GPU and not stored; reading it back to store
+        // would cost more than the draw it saves
+        describePlanet(imgs, seed);
+    }
 }
 
-Color getRandomColor() {
-    return (Color){GetRandomValue(0, 255), GetRandomValue(0, 255),
-                   GetRandomValue(0, 255), 255};
+// uploads the generated layers into p. render thread only, and outside texture
+// mode: the GPU backend draws into its own targets and EndTextureMode would
+// leave the screen bound in place of the frame's target
+void uploadPlanet(Planet* p, const PlanetImages* imgs) {
+    ProfileScope scope = profileBegin("planet upload");
+    if (imgs->land.data != NULL) {
+        p->land = LoadTextureFromImage(imgs->land);
+        p->atmosphere = LoadTextureFromImage(imgs->atmosphere);
+    } else {
+        planetBackend->textures(&imgs->layers, &p->land, &p->atmosphere);
+    }
+    p->palette = imgs->palette;
+    p->avg = imgs->atmColor;
+    strncpy(p->name, imgs->name, PLANET_NAME_MAXLEN);
+    profileEnd(scope);
 }
 
-void drawPlanetName(const Color avg, const v2* pos, const char* name, f32 scale) {
-    const i32 spacing = 1;
-    i32 len = MeasureTextEx(globalFont, name, PLANET_NAME_SIZE, spacing).x;
-    v2 center = {pos->x + PLANET_RES * scale / 2.0,
-                 pos->y + PLANET_RES * scale / 2.0};
-    v2 textPos = {center.x - len / 2.0, center.y - PLANET_RES * scale / 2.0 - 30};
-
-    DrawTextEx(globalFont, name, textPos, PLANET_NAME_SIZE, spacing, avg);
+ecs_entity_t spawnPlanet(v2 pos, f32 scale, const PlanetImages* imgs) {
+    ecs_entity_t e = spawnPlanetPending(pos, scale, imgs->seed);
+    uploadPlanet(ecs_get_mut(world, e, Planet), imgs);
+    return e;
 }
 
-void planetRender(ecs_entity_t e) {
-    const Planet* p = ecs_get(world, e, Planet);
-    const position_c* pos = ecs_get(world, e, position_c);
-
-    DrawTextureEx(p->land, (v2){pos->x, pos->y}, 0, p->scale, WHITE);
-    DrawTextureEx(p->atmosphere,
-                  (v2){pos->x - p->atmosphereOffset * (p->scale / 2.0),
-                       pos->y - p->atmosphereOffset * (p->scale / 2.0)},
-                  0, p->scale, WHITE);
-
-    drawColorRamp(&p->palette);
-    drawPlanetName(p->avg, &(v2){pos->x, pos->y}, p->name, p->scale);
+ecs_entity_t createPlanet(v2 pos, f32 scale) {
+    return createPlanetFromSeed(pos, scale, randomSeed());
 }
 
-char** planetNames = NULL;
-
-void loadPlanetNames() {
-    FILE* file = fopen(PLANET_NAMES_PATH, "r");
-    if (file == NULL) {
-        perror("Error reading file");
-        return;
-    }
+// everything about the planet, name included, is derived from seed
+ecs_entity_t createPlanetFromSeed(v2 pos, f32 scale, u64 seed) {
+    PlanetImages imgs;
+    preparePlanetImages(&imgs, seed);
+    ecs_entity_t e = spawnPlanet(pos, scale, &imgs);
+    unloadPlanetImages(&imgs);
+    return e;
+}
 
-    planetNames = malloc(sizeof(char*) * 500);
-    if (planetNames == NULL) {
-        perror("Error allocating memory in loadPlanetNames");
-        fclose(file);
-        return;
+static bool containsEntity(const ecs_entity_t* list, usize len, ecs_entity_t e) {
+    for (usize i = 0; i < len; i++) {
+        if (list[i] == e) return true;
     }
+    return false;
+}
 
-    char* line = NULL;
-    size_t len = 0;
-    ssize_t read;
-    usize i = 0;
-
-    while ((read = getline(&line, &len, file)) != -1) {
-        planetNames[i] = malloc(sizeof(char) * PLANET_NAME_MAXLEN);
-        if (planetNames[i] == NULL) {
-            perror("Error allocating memory in loadPlanetNames");
-            fclose(file);
-            return;
+/**
+ * Hit-tests the mouse against the grid cell it is in, so the cost does not
+ * grow with the number of clickables. Hover callbacks only fire on enter and
+ * exit; onClick fires for everything under the mouse.
+ */
+void HandleClickables(ecs_iter_t* it) {
+    const InputState* in = ecs_field(it, InputState, 0);
+    ecs_entity_t hits[CLICKABLE_MAX_HOVERED];
+    usize n = gridQueryPoint(clickableGrid, in->mouse, hits, CLICKABLE_MAX_HOVERED);
+
+    for (usize i = 0; i < hoveredLen;) {
+        if (containsEntity(hits, n, hovered[i])) {
+            i++;
+            continue;
         }
 
-        strncpy(planetNames[i], line, PLANET_NAME_MAXLEN);
-        i++;
+        const Clickable* c = ecs_get(it->world, hovered[i], Clickable);
+        if (c != NULL) c->hoverReset(hovered[i]);
+        hovered[i] = hovered[--hoveredLen];
     }
 
-    fclose(file);
-    free(line);
-}
-
-char* getPlanetName() {
-    if (planetNames == NULL) {
-        loadPlanetNames();
-    }
-
-    if (planetNames == NULL) {
-        return NULL;
-    }
+    bool pressed = inputButtonPressed(in, MOUSE_BUTTON_LEFT);
+    for (usize i = 0; i < n; i++) {
+        const Clickable* c = ecs_get(it->world, hits[i], Clickable);
 
-    char* name = malloc(sizeof(char) * PLANET_NAME_MAXLEN);
-    if (name == NULL) {
-        perror("Error allocating memory in getPlanetName");
-        return NULL;
+        if (!containsEntity(hovered, hoveredLen, hits[i])) {
+            hovered[hoveredLen++] = hits[i];
+            c->onHover(hits[i]);
+        }
+        if (pressed) c->onClick(hits[i]);
     }
-
-    usize i = GetRandomValue(0, 500);
-    strncpy(name, planetNames[i], PLANET_NAME_MAXLEN);
-    return name;
-}
-
-void onPlanetHover(ecs_entity_t e) {
-    const Planet* p = ecs_get(world, e, Planet);
-    const position_c* pos = ecs_get(world, e, position_c);
-
-    v2 center = {pos->x + PLANET_RES * p->scale / 2.0,
-                 pos->y + PLANET_RES * p->scale / 2.0};
-    f32 rad = (PLANET_RES * ATMOSPHERE_SCALE * p->scale) / 2 + 1;
-    DrawCircleLines(center.x, center.y, rad, GRUV_BLUE);
-}
-
-void onPlanetExitHover(ecs_entity_t e) {
-    (void)e;
-    return;
 }
 
-void onPlanetClick(ecs_entity_t e) {
-    const Planet* p = ecs_get(world, e, Planet);
-    printf("Clicked on planet %s which is entity %ld \n", p->name, e);
-    selectedPlanet_p = p;
-}
-
-i32 orderPlanets(ecs_entity_t e1, const void* a, ecs_entity_t e2, const void* b) {
-    (void)e1;
-    (void)e2;
-
-    const Planet* p1 = (const Planet*)a;
-    const Planet* p2 = (const Planet*)b;
-
-    return p1->order - p2->order;
-}
-
-Texture2D createPlanetBackground(Planet p) {
-    Image l1 = colorPerlin(PERLIN, 640, p.palette, 20);
-    Image l2 = colorPerlin(CELLULAR, 640, p.palette, 20);
-    Image l3 = averageImages(l1, l2);
-
-    Texture2D final = LoadTextureFromImage(l3);
-    UnloadImage(l1);
-    UnloadImage(l2);
-    UnloadImage(l3);
-    return final;
-}
-
-ecs_entity_t createPlanet(v2 pos, f32 scale) {
-    static u8 order = 0;
-    Color* cls =
-        generateHarmonizedColors(brightenColor(getRandomColor()), 6, 25, 1, 1);
-    ColorRamp ramp = createColorRampAuto(cls, 6, 255);
-
-    Color atmColor = brightenColor(averageRamp(&ramp));
-    atmColor.a = GetRandomValue(100, 200); // atmosphere density
-
-    // terrain noise
-    Image noiseSq = colorPerlin(PERLIN, PLANET_RES, ramp, -1);
-    Image noiseShadow = dither(0, -PLANET_RES / 8, noiseSq);
-    Image noise = cropToCircle(noiseShadow);
-    Texture2D tex = LoadTextureFromImage(noise);
-
-    // atmosphere
-    Image atmSolid = GenImageColor(PLANET_RES * ATMOSPHERE_SCALE,
-                                   PLANET_RES * ATMOSPHERE_SCALE, atmColor);
-    Image atmShadow = dither(0, -PLANET_RES / 8, atmSolid);
-    Image atmC = cropToCircle(atmShadow);
-    Texture2D atm = LoadTextureFromImage(atmC);
-
-    i32 atmosphereOffset = (PLANET_RES * ATMOSPHERE_SCALE - PLANET_RES);
+// moves hitboxes in the grid. change detection is per table, so only tables
+// that were written to since the last run are walked
+void SyncClickables(ecs_iter_t* it) {
+    if (!ecs_iter_changed(it)) return;
 
-    // name gen
-    char* name = getPlanetName();
-    if (name == NULL) {
-        name = "NAME ERROR";
-    }
+    const position_c* p = ecs_field(it, position_c, 0);
+    const Clickable* c = ecs_field(it, Clickable, 1);
 
-    if (!strcmp(name, "NAME ERROR")) {
-        free(name);
+    for (i32 i = 0; i < it->count; i++) {
+        Rect box = {p[i].x, p[i].y, c[i].hitbox.x, c[i].hitbox.y};
+        gridUpdate(clickableGrid, it->entities[i], box);
     }
-
-    ecs_entity_t e = ecs_new(world);
-    ecs_set(world, e, Planet,
-            {.land = tex,
-             .atmosphere = atm,
-             .palette = ramp,
-             .atmosphereOffset = atmosphereOffset,
-             .avg = atmColor,
-             .scale = scale,
-             .order = order});
-
-    strncpy(ecs_get_mut(world, e, Planet)->name, name, PLANET_NAME_MAXLEN);
-    ecs_get_mut(world, e, Planet)->background =
-        createPlanetBackground(*ecs_get(world, e, Planet));
-    ecs_set(world, e, position_c, {pos.x, pos.y});
-    ecs_set(world, e, Renderable, {1, planetRender});
-    // clang-format off
-    ecs_set(world, e, Clickable, {onPlanetClick, onPlanetHover, onPlanetExitHover,{PLANET_RES * scale, PLANET_RES * scale}});
-    // clang-format on
-
-    // cleanup
-    UnloadImage(noiseSq);
-    UnloadImage(noiseShadow);
-    UnloadImage(noise);
-    UnloadImage(atmSolid);
-    UnloadImage(atmShadow);
-    UnloadImage(atmC);
-    free(cls);
-    cls = NULL;
-    order++;
-
-    return e;
 }
 
-void HandleClickables(ecs_iter_t* it) {
-    const Clickable* c = ecs_field(it, Clickable, 1);
-    const position_c* p = ecs_field(it, position_c, 0);
+// a clickable stopped matching: deleted, lost a component or was disabled
+void ClickableRemoved(ecs_iter_t* it) {
+    if (it->event != EcsOnRemove) return;
 
     for (i32 i = 0; i < it->count; i++) {
-        Rect box = {p[i].x, p[i].y, c[i].hitbox.x, c[i].hitbox.y};
+        ecs_entity_t e = it->entities[i];
+        gridRemove(clickableGrid, e);
 
-        if (CheckCollisionPointRec(*mouse, box)) {
-            if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                c[i].onClick(it->entities[i]);
-            } else {
-                c[i].onHover(it->entities[i]);
-            }
-        } else {
-            c[i].hoverReset(it->entities[i]);
+        for (usize h = 0; h < hoveredLen; h++) {
+            if (hovered[h] != e) continue;
+
+            const Clickable* c = ecs_get(it->world, e, Clickable);
+            if (c != NULL) c->hoverReset(e);
+            hovered[h] = hovered[--hoveredLen];
+            break;
         }
     }
 }
@@ -557,99 +399,115 @@ Texture2D genCosmicBackground() {
     },
     6, 255);
     // clang-format on
-    Image colored = colorPerlin(PERLIN, screenWidth, cosmicRamp, 30);
+    Image colored = colorPerlin(PERLIN, screenWidth, cosmicRamp, 30, randomSeed());
     return LoadTextureFromImage(colored);
 }
 
-bool reachedMaxScroll(const f32 numScrolls, const usize size, const bool direction) {
-    printf("scrolls: %f\n", numScrolls);
-    if (!direction) {
-        return numScrolls >= size - 1; // right
-    } else {
-        return numScrolls <= 0; // left
-    }
+void planetImagesJob(void* arg) {
+    PlanetJob* job = arg;
+    preparePlanetImages(&job->imgs, job->imgs.seed);
+    atomic_store(&job->ready, true);
 }
 
-v2 lerp_v2(v2 a, v2 b, f32 t) { return (v2){lerp(a.x, b.x, t), lerp(a.y, b.y, t)}; }
+// starts generating e's images in the background; StreamPlanets uploads them
+void streamPlanet(ecs_entity_t e) {
+    PlanetJob* job = malloc(sizeof(PlanetJob));
+    if (job == NULL) {
+        perror("Error allocating memory in streamPlanet");
+        return;
+    }
 
-void scrollPlanet(ecs_entity_t container, bool dir, bool increase, bool* done) {
-    position_c* containerPos = ecs_get_mut(world, container, position_c);
-    f32* numScrolls = &containerPos->x;
+    // the name list is loaded lazily; do it before the workers race for it
+    if (planetNames == NULL) {
+        loadPlanetNames();
+    }
 
-    ecs_query_t* q =
-        ecs_query(world, {.terms = {{.id = ecs_childof(container)},
-                                    {.id = ecs_id(Planet), .inout = EcsIn},
-                                    {.id = ecs_id(position_c), .inout = EcsIn}},
-                          .order_by = ecs_id(Planet),
-                          .order_by_callback = orderPlanets});
+    job->imgs.seed = ecs_get(world, e, Planet)->seed;
+    atomic_init(&job->ready, false);
+    ecs_set(world, e, PlanetPending, {job});
+    jobsSubmit(planetImagesJob, job);
+}
 
-    ecs_iter_t it = ecs_query_iter(world, q);
+void StreamPlanets(ecs_iter_t* it) {
+    static i64 frame = -1;
+    static i32 uploads = 0;
 
-    const f32 scale = 1.5;
-    const v2 mid = {screenWidth / 2.0 - PLANET_RES * scale / 2,
-                    screenHeight / 2.0 - PLANET_RES * scale / 2 + 20};
-    *done = false;
+    Planet* p = ecs_field(it, Planet, 0);
+    const PlanetPending* pending = ecs_field(it, PlanetPending, 1);
 
-    while (ecs_query_next(&it)) {
-        position_c* p = ecs_field(&it, position_c, 2);
+    // the budget is per frame, not per matched table
+    i64 now = ecs_get_world_info(it->world)->frame_count_total;
+    if (now != frame) {
+        frame = now;
+        uploads = 0;
+    }
 
-        bool max = reachedMaxScroll(*numScrolls, it.count, dir);
-        if (max && done && increase) {
-            printf("max\n");
-            *done = true;
-            return;
-        }
-        if (increase && !max) {
-            if (!dir) {
-                *numScrolls += 1;
-            } else {
-                *numScrolls -= 1;
-            }
-        }
+    for (i32 i = 0; i < it->count && uploads < PLANET_UPLOADS_PER_FRAME; i++) {
+        PlanetJob* job = pending[i].job;
+        if (!atomic_load(&job->ready)) continue;
 
-        for (i32 i = 0; i < it.count; i++) {
-            f32 diff = ABS((p[i].x - ((-*numScrolls + i) * screenWidth + mid.x)));
-
-            p[i].x = lerp(p[i].x, (-*numScrolls + i) * screenWidth + mid.x,
-                          GetFrameTime() * 3);
-            if (i == it.count - 1) {
-                if (diff <= 1) {
-                    *done = true;
-                    printf("done\n");
-                } else {
-                    *done = false;
-                }
-            }
-        }
+        uploadPlanet(&p[i], &job->imgs);
+        unloadPlanetImages(&job->imgs);
+        free(job);
+        ecs_remove(it->world, it->entities[i], PlanetPending);
+        uploads++;
     }
 }
 
-ecs_entity_t createPlanetContainer(i32 count) {
-    ecs_entity_t container = ecs_new(world);
-    ecs_set(world, container, position_c, {0, 0});
+// returns immediately; the planets stream in over the following frames.
+// child seeds are derived from seed, so the same carousel hits the disk cache
+ecs_entity_t createPlanetContainer(i32 count, u64 seed) {
+    Rng rng = rngInit(seed);
 
     const f32 scale = 1.5;
     const v2 pos = {screenWidth / 2.0 - PLANET_RES * scale / 2,
                     screenHeight / 2.0 - PLANET_RES * scale / 2 + 20};
-
-    const f32 offset = screenWidth;
+    ecs_entity_t carousel = createCarousel(pos, screenWidth);
 
     for (i32 i = 0; i < count; i++) {
-        ecs_entity_t p = createPlanet((v2){pos.x + i * offset, pos.y}, scale);
-        ecs_add_id(world, p, ecs_id(_scrollablePlanet));
-        ecs_add_pair(world, p, EcsChildOf, container);
+        ecs_entity_t p = spawnPlanetPending(pos, scale, rngNext(&rng));
+        carouselAdd(carousel, p);
+        streamPlanet(p);
     }
 
-    return container;
+    return carousel;
 }
 
+/**
+ * Draws planets with the GPU backend, when it can run here, instead of the
+ * CPU one. A planet then takes one draw call per layer rather than a worker's
+ * time, but cache misses are drawn on the render thread. Call before importing
+ * PlanetModule; the CPU backend is the default, headless runs included.
+ */
+void planetPreferGPU(bool prefer) { preferGPU = prefer; }
+
 void PlanetModuleImport(ecs_world_t* world) {
+    ECS_IMPORT(world, InputModule);
     ECS_IMPORT(world, TransformModule);
+    ECS_IMPORT(world, CarouselModule);
     ECS_MODULE(world, PlanetModule);
 
+    planetBackend = planetBackendSelect(preferGPU);
+    TraceLog(LOG_INFO, "PLANET: Backend: %s", planetBackend->name);
+    planetCacheSweep();
+
     ECS_COMPONENT_DEFINE(world, Planet);
-    ECS_TAG_DEFINE(world, _scrollablePlanet);
     ECS_COMPONENT_DEFINE(world, Clickable);
+    ECS_COMPONENT_DEFINE(world, PlanetPending);
+    ECS_TAG_DEFINE(world, _hovered);
+
+    // hit tests use last frame's hitboxes, which is what is on screen
+    clickableGrid = gridCreate(GRID_CELL_SIZE);
     ECS_SYSTEM_DEFINE(world, HandleClickables, EcsOnUpdate,
-                      transform.module.position_c, Clickable);
+                      [in] input.module.InputState($));
+    ECS_SYSTEM_DEFINE(world, SyncClickables, EcsPostUpdate,
+                      [in] transform.module.position_c, [in] Clickable);
+    ecs_observer(world, {.query.terms = {{.id = ecs_id(position_c)},
+                                         {.id = ecs_id(Clickable)}},
+                         .events = {EcsMonitor},
+                         .callback = ClickableRemoved});
+    ECS_SYSTEM_DEFINE(world, StreamPlanets, EcsPreUpdate, Planet, PlanetPending);
+    ECS_SYSTEM_DEFINE(world, DrawPlanets, EcsPreStore, [in] Planet,
+                      [in] transform.module.position_c, ?_hovered,
+                      [in] ?transform.module.prevPosition_c);
 }
@@ -0,0 +1,160 @@
+#include "planetBackend.h"
+#include "raylib.h"
+#include "rlgl.h"
+#include <stdio.h>
+
+/*
+ * CPU backend
+ */
+
+static bool cpuInit(void) { return true; }
+
+static void cpuShutdown(void) {}
+
+static void cpuTextures(const PlanetLayerDesc* d, Texture2D* land,
+                        Texture2D* atmosphere) {
+    Image l, a;
+    generatePlanetLayers(d, &l, &a);
+    *land = LoadTextureFromImage(l);
+    *atmosphere = LoadTextureFromImage(a);
+    UnloadImage(l);
+    UnloadImage(a);
+}
+
+const PlanetBackend planetBackendCPU = {.name = "cpu",
+                                        .threaded = true,
+                                        .init = cpuInit,
+                                        .shutdown = cpuShutdown,
+                                        .images = generatePlanetLayers,
+                                        .textures = cpuTextures};
+
+/*
+ * GPU backend. planet.fs evaluates the same noise, ramp and shading per
+ * fragment; the uniforms below are what the CPU path derives per planet.
+ */
+
+#define PLANET_SHADER_OCTAVES 8
+
+enum { LAYER_LAND, LAYER_ATMOSPHERE };
+
+static Shader planetShader;
+static i32 locMode, locRes, locShadow, locAtmColor, locLut, locOctaves;
+static i32 locSeeds[2], locSteps[2];
+
+static bool gpuInit(void) {
+    if (!IsWindowReady()) return false;
+
+    planetShader = LoadShader(0, PLANET_SHADER_PATH);
+    // raylib falls back to its default shader when compilation fails
+    if (!IsShaderValid(planetShader) || planetShader.id == rlGetShaderIdDefault()) {
+        fprintf(stderr, "Error loading %s, using the cpu backend\n",
+                PLANET_SHADER_PATH);
+        return false;
+    }
+
+    locMode = GetShaderLocation(planetShader, "mode");
+    locRes = GetShaderLocation(planetShader, "res");
+    locShadow = GetShaderLocation(planetShader, "shadowCentre");
+    locAtmColor = GetShaderLocation(planetShader, "atmColor");
+    locLut = GetShaderLocation(planetShader, "lut");
+    locOctaves = GetShaderLocation(planetShader, "octaves");
+    locSeeds[0] = GetShaderLocation(planetShader, "seeds1");
+    locSeeds[1] = GetShaderLocation(planetShader, "seeds2");
+    locSteps[0] = GetShaderLocation(planetShader, "step1");
+    locSteps[1] = GetShaderLocation(planetShader, "step2");
+    return true;
+}
+
+static void gpuShutdown(void) {
+    if (planetShader.id != 0) UnloadShader(planetShader);
+    planetShader = (Shader){0};
+}
+
+// draws one layer and keeps only the colour texture of the render target
+static Texture2D drawLayer(i32 layer, i32 res, const PlanetLayerDesc* d,
+                           Texture2D lut) {
+    RenderTexture2D target = LoadRenderTexture(res, res);
+    i32 centre[2] = {res / 2 + d->shadowOffsetx, res / 2 + d->shadowOffsety};
+    f32 atm[4] = {d->atmColor.r, d->atmColor.g, d->atmColor.b, d->atmColor.a};
+
+    BeginTextureMode(target);
+    ClearBackground(BLANK);
+    BeginShaderMode(planetShader);
+
+    SetShaderValue(planetShader, locMode, &layer, SHADER_UNIFORM_INT);
+    SetShaderValue(planetShader, locRes, &res, SHADER_UNIFORM_INT);
+    SetShaderValue(planetShader, locShadow, centre, SHADER_UNIFORM_IVEC2);
+    SetShaderValue(planetShader, locAtmColor, atm, SHADER_UNIFORM_VEC4);
+    if (layer == LAYER_LAND) SetShaderValueTexture(planetShader, locLut, lut);
+
+    // the shader writes final pixels, alpha included; blending would premultiply
+    rlDrawRenderBatchActive();
+    rlDisableColorBlend();
+    DrawRectangle(0, 0, res, res, WHITE);
+    rlDrawRenderBatchActive();
+    rlEnableColorBlend();
+
+    EndShaderMode();
+    EndTextureMode();
+
+    rlUnloadFramebuffer(target.id);
+    return target.texture;
+}
+
+static void gpuTextures(const PlanetLayerDesc* d, Texture2D* land,
+                        Texture2D* atmosphere) {
+    Rng rng = rngInit(d->landSeed);
+    NoiseDesc nd[2];
+    planetNoiseDescs(PERLIN, d->res, -1, &rng, &nd[0], &nd[1]);
+
+    for (i32 i = 0; i < 2; i++) {
+        i32 seeds[PLANET_SHADER_OCTAVES];
+        noiseOctaveSeeds(&nd[i], (u32*)seeds, PLANET_SHADER_OCTAVES);
+        f32 step = nd[i].frequency / d->res; // as noiseFieldU8 computes it
+
+        SetShaderValueV(planetShader, locSeeds[i], seeds, SHADER_UNIFORM_INT,
+                        PLANET_SHADER_OCTAVES);
+        SetShaderValue(planetShader, locSteps[i], &step, SHADER_UNIFORM_FLOAT);
+    }
+    i32 octaves = MIN(nd[0].octaves, PLANET_SHADER_OCTAVES);
+    SetShaderValue(planetShader, locOctaves, &octaves, SHADER_UNIFORM_INT);
+
+    Color lutPx[256];
+    rampLUT(&d->palette, lutPx);
+    Image lutImg = {.data = lutPx,
+                    .width = 256,
+                    .height = 1,
+                    .mipmaps = 1,
+                    .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+    Texture2D lut = LoadTextureFromImage(lutImg);
+
+    *land = drawLayer(LAYER_LAND, d->res, d, lut);
+    *atmosphere = drawLayer(LAYER_ATMOSPHERE, d->res * ATMOSPHERE_SCALE, d, lut);
+
+    UnloadTexture(lut);
+}
+
+// reads the layers back; for comparing against the CPU backend, not for play
+static void gpuImages(const PlanetLayerDesc* d, Image* land, Image* atmosphere) {
+    Texture2D l, a;
+    gpuTextures(d, &l, &a);
+    *land = LoadImageFromTexture(l);
+    *atmosphere = LoadImageFromTexture(a);
+    UnloadTexture(l);
+    UnloadTexture(a);
+}
+
+const PlanetBackend planetBackendGPU = {.name = "gpu",
+                                        .threaded = false,
+                                        .init = gpuInit,
+                                        .shutdown = gpuShutdown,
+                                        .images = gpuImages,
+                                        .textures = gpuTextures};
+
+// the GPU backend when asked for and usable, otherwise the CPU one
+const PlanetBackend* planetBackendSelect(bool preferGPU) {
+    if (preferGPU && planetBackendGPU.init()) return &planetBackendGPU;
+
+    planetBackendCPU.init();
+    return &planetBackendCPU;
+}
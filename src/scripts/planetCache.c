@@ -0,0 +1,222 @@
+#include "planetCache.h"
+#include "profiler.h"
+#include <errno.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define PLANET_CACHE_PATH_MAX 256
+#define PLANET_CACHE_LAYERS 2
+
+typedef struct {
+    u32 width;
+    u32 height;
+    u64 offset;
+} PlanetCacheLayer;
+
+typedef struct {
+    u32 magic;
+    u32 version;
+    u64 seed;
+    u64 paramsHash;
+    ColorRamp palette;
+    Color atmColor;
+    char name[PLANET_NAME_MAXLEN];
+    PlanetCacheLayer layers[PLANET_CACHE_LAYERS]; // land, atmosphere
+} PlanetCacheHeader;
+
+static u64 fnv1a(u64 h, const void* data, usize len) {
+    const u8* p = data;
+    for (usize i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+// everything besides the seed that changes what generatePlanetImages makes
+u64 planetParamsHash(void) {
+    const i64 params[] = {PLANET_GEN_VERSION, PLANET_RES, PLANET_BG_RES,
+                          (i64)(ATMOSPHERE_SCALE * 1000), MAX_COLORRAMP_STEPS,
+                          PLANET_NAME_MAXLEN};
+    return fnv1a(0xcbf29ce484222325ull, params, sizeof(params));
+}
+
+static void cachePath(char* out, u64 seed) {
+    snprintf(out, PLANET_CACHE_PATH_MAX, "%s/%016llx-%016llx.planet",
+             PLANET_CACHE_DIR, (unsigned long long)seed,
+             (unsigned long long)planetParamsHash());
+}
+
+static bool ensureDir(const char* path) {
+    char buf[PLANET_CACHE_PATH_MAX];
+    strncpy(buf, path, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+
+    for (char* c = buf + 1; *c; c++) {
+        if (*c != '/') continue;
+        *c = '\0';
+        if (mkdir(buf, 0755) != 0 && errno != EEXIST) return false;
+        *c = '/';
+    }
+    return mkdir(buf, 0755) == 0 || errno == EEXIST;
+}
+
+static bool layerValid(const PlanetCacheLayer* l, usize size) {
+    u64 bytes = (u64)l->width * l->height * sizeof(Color);
+    return l->width > 0 && l->height > 0 && l->offset <= size &&
+           bytes <= size - l->offset;
+}
+
+static Image layerImage(u8* base, const PlanetCacheLayer* l) {
+    return (Image){.data = base + l->offset,
+                   .width = l->width,
+                   .height = l->height,
+                   .mipmaps = 1,
+                   .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+}
+
+// maps the cached planet for seed into out. the layers point into the mapping
+bool planetCacheLoad(PlanetImages* out, u64 seed) {
+    char path[PLANET_CACHE_PATH_MAX];
+    cachePath(path, seed);
+
+    i32 fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (usize)st.st_size < sizeof(PlanetCacheHeader)) {
+        close(fd);
+        return false;
+    }
+
+    usize size = st.st_size;
+    u8* base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return false;
+
+    const PlanetCacheHeader* h = (const PlanetCacheHeader*)base;
+    bool ok = h->magic == PLANET_CACHE_MAGIC && h->version == PLANET_GEN_VERSION &&
+              h->seed == seed && h->paramsHash == planetParamsHash();
+    for (i32 i = 0; ok && i < PLANET_CACHE_LAYERS; i++) {
+        ok = layerValid(&h->layers[i], size);
+    }
+
+    if (!ok) {
+        munmap(base, size);
+        return false;
+    }
+
+    out->seed = seed;
+    out->palette = h->palette;
+    out->atmColor = h->atmColor;
+    memcpy(out->name, h->name, PLANET_NAME_MAXLEN);
+    out->land = layerImage(base, &h->layers[0]);
+    out->atmosphere = layerImage(base, &h->layers[1]);
+    out->mapping = base;
+    out->mappingSize = size;
+    return true;
+}
+
+/**
+ * Writes imgs to the cache. The file is written under a temporary name and
+ * renamed into place, so concurrent writers and readers never see half a file.
+ */
+bool planetCacheStore(const PlanetImages* imgs) {
+    static atomic_uint tmpCounter = 0;
+
+    if (!ensureDir(PLANET_CACHE_DIR)) {
+        perror("Error creating planet cache directory");
+        return false;
+    }
+
+    const Image* layers[PLANET_CACHE_LAYERS] = {&imgs->land, &imgs->atmosphere};
+    PlanetCacheHeader h = {.magic = PLANET_CACHE_MAGIC,
+                           .version = PLANET_GEN_VERSION,
+                           .seed = imgs->seed,
+                           .paramsHash = planetParamsHash(),
+                           .palette = imgs->palette,
+                           .atmColor = imgs->atmColor};
+    memcpy(h.name, imgs->name, PLANET_NAME_MAXLEN);
+
+    u64 offset = sizeof(h);
+    for (i32 i = 0; i < PLANET_CACHE_LAYERS; i++) {
+        h.layers[i] = (PlanetCacheLayer){layers[i]->width, layers[i]->height, offset};
+        offset += (u64)layers[i]->width * layers[i]->height * sizeof(Color);
+    }
+
+    char path[PLANET_CACHE_PATH_MAX];
+    char tmp[PLANET_CACHE_PATH_MAX + 32];
+    cachePath(path, imgs->seed);
+    snprintf(tmp, sizeof(tmp), "%s.%d.%u.tmp", path, (i32)getpid(),
+             atomic_fetch_add(&tmpCounter, 1));
+
+    FILE* file = fopen(tmp, "wb");
+    if (file == NULL) {
+        perror("Error writing planet cache");
+        return false;
+    }
+
+    bool ok = fwrite(&h, sizeof(h), 1, file) == 1;
+    for (i32 i = 0; ok && i < PLANET_CACHE_LAYERS; i++) {
+        usize count = (usize)layers[i]->width * layers[i]->height;
+        ok = fwrite(layers[i]->data, sizeof(Color), count, file) == count;
+    }
+
+    ok = fclose(file) == 0 && ok;
+    if (!ok || rename(tmp, path) != 0) {
+        perror("Error writing planet cache");
+        remove(tmp);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Deletes cached planets made with other generation parameters. Nothing would
+ * ever read them again, since the hash is part of the name. Half written
+ * temporaries are left alone, another instance may still be writing them.
+ */
+void planetCacheSweep(void) {
+    DIR* dir = opendir(PLANET_CACHE_DIR);
+    if (dir == NULL) return;
+
+    char current[32];
+    snprintf(current, sizeof(current), "-%016llx.planet",
+             (unsigned long long)planetParamsHash());
+    usize currentLen = strlen(current);
+
+    struct dirent* ent;
+    while ((ent = readdir(dir)) != NULL) {
+        const char* ext = strrchr(ent->d_name, '.');
+        if (ext == NULL || strcmp(ext, ".planet") != 0) continue;
+
+        usize len = strlen(ent->d_name);
+        if (len >= currentLen && !strcmp(ent->d_name + len - currentLen, current)) {
+            continue;
+        }
+
+        if (unlinkat(dirfd(dir), ent->d_name, 0) != 0) {
+            perror("Error removing stale planet cache");
+        }
+    }
+    closedir(dir);
+}
+
+// the cached planet when there is one, otherwise generates and caches it
+void loadOrGeneratePlanetImages(PlanetImages* out, u64 seed) {
+    ProfileScope scope = profileBegin("planet cache load");
+    bool hit = planetCacheLoad(out, seed);
+    profileEnd(scope);
+    if (hit) return;
+
+    generatePlanetImages(out, seed);
+    scope = profileBegin("planet cache store");
+    planetCacheStore(out);
+    profileEnd(scope);
+}
@@ -0,0 +1,494 @@
+#include "planetGen.h"
+#include "pixel.h"
+#include "profiler.h"
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#define PLANET_NAMES_PATH "assets/planet_names.txt"
+
+char** planetNames = NULL;
+usize planetNameCount = 0;
+
+ColorRamp createColorRampAuto(Color* colors, usize len, i32 max) {
+    i32 step = max / len;
+    ColorRamp r;
+
+    for (usize i = 0; i < len - 1; i++) {
+        r.steps[i] = (i + 1) * step;
+    }
+    for (usize i = 0; i < len; i++) {
+        r.colors[i] = colors[i];
+    }
+    r.steps[len - 1] = max;
+    r.len = len;
+    return r;
+}
+
+ColorRamp createColorRamp(i32* steps, Color* colors, usize len) {
+    ColorRamp r;
+    for (usize i = 0; i < len; i++) {
+        r.steps[i] = steps[i];
+        r.colors[i] = colors[i];
+    }
+    r.len = len;
+    return r;
+}
+
+// Function to interpolate between colors in the ColorRamp
+Color getColorFromRamp(float t, ColorRamp ramp) {
+    for (usize i = 0; i < ramp.len - 1; i++) {
+        if (t <= ramp.steps[i]) return ramp.colors[i];
+    }
+    return ramp.colors[ramp.len - 1];
+}
+
+Image averageImages(Image m1, Image m2) {
+    assert(m1.width == m2.width && m1.height == m2.height &&
+           "Images must be the same size");
+
+    Image ret = ImageCopy(m1);
+    Image other =
+        m2.format == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 ? m2 : ImageCopy(m2);
+    Color* p = imageRGBA8(&ret);
+
+    pixAverage(p, p, imageRGBA8(&other), (usize)(m1.width * m1.height));
+
+    if (other.data != m2.data) UnloadImage(other);
+    return ret;
+}
+
+void cropToCircleImage(Image* img) {
+    pixCropToCircle(imageRGBA8(img), img->width, img->height);
+}
+
+Image cropToCircle(Image img) {
+    Image ret = ImageCopy(img);
+    cropToCircleImage(&ret);
+    return ret;
+}
+
+void ditherImage(i32 circleOffsetx, i32 circleOffsety, Image* m) {
+    assert(m->width == m->height && "Image must be square");
+
+    i32 cx = m->width / 2 + circleOffsetx;
+    i32 cy = m->height / 2 + circleOffsety;
+    pixShadow(imageRGBA8(m), m->width, m->height, cx, cy);
+}
+
+Image dither(i32 circleOffsetx, i32 circleOffsety, Image m) {
+    Image ret = ImageCopy(m);
+    ditherImage(circleOffsetx, circleOffsety, &ret);
+    return ret;
+}
+
+Color HSVtoRGB(i32 h, i32 s, i32 v) {
+    f32 r, g, b;
+    f32 f, p, q, t;
+
+    f32 S = s / 100.0;
+    f32 V = v / 100.0;
+
+    if (s == 0) {
+        r = g = b = V;
+    } else {
+        f = (h % 60) / 60.0;
+        p = V * (1 - S);
+        q = V * (1 - S * f);
+        t = V * (1 - S * (1 - f));
+
+        // hue wraps, so 360 is red again like 0
+        switch ((h / 60) % 6) {
+        case 0:
+            r = V;
+            g = t;
+            b = p;
+            break;
+        case 1:
+            r = q;
+            g = V;
+            b = p;
+            break;
+        case 2:
+            r = p;
+            g = V;
+            b = t;
+            break;
+        case 3:
+            r = p;
+            g = q;
+            b = V;
+            break;
+        case 4:
+            r = t;
+            g = p;
+            b = V;
+            break;
+        default:
+            r = V;
+            g = p;
+            b = q;
+            break;
+        }
+    }
+
+    return (Color){(u8)(r * 255), (u8)(g * 255), (u8)(b * 255), 255};
+}
+
+void RGBtoHSV(Color c, i32* h, i32* s, i32* v) {
+    f32 r = c.r / 255.0;
+    f32 g = c.g / 255.0;
+    f32 b = c.b / 255.0;
+
+    f32 max = fmax(r, fmax(g, b));
+    f32 min = fmin(r, fmin(g, b));
+    f32 d = max - min;
+
+    if (d == 0) {
+        *h = 0;
+    } else if (max == r) {
+        *h = 60 * fmod((g - b) / d, 6);
+        if (*h < 0) *h += 360;
+    } else if (max == g) {
+        *h = 60 * ((b - r) / d + 2);
+    } else if (max == b) {
+        *h = 60 * ((r - g) / d + 4);
+    }
+
+    *s = (max == 0) ? 0 : (d / max) * 100;
+    *v = max * 100;
+}
+
+Color* generateHarmonizedColors(Color baseColor, i32 colorCount, i32 hueShift,
+                                float saturationFactor, float brightnessFactor) {
+    Color* colors = (Color*)malloc(sizeof(Color) * colorCount);
+    i32 hue, saturation, brightness;
+
+    // Convert the base color to HSV
+    RGBtoHSV(baseColor, &hue, &saturation, &brightness);
+
+    // Generate colors by adjusting the hue, saturation, and brightness
+    for (i32 i = 0; i < colorCount; i++) {
+        i32 newHue = (hue + i * hueShift) % 360;
+        i32 newSaturation = (int)(saturation * saturationFactor);
+        i32 newBrightness = (int)(brightness * brightnessFactor);
+
+        // Store the new color in the array
+        colors[i] = HSVtoRGB(newHue, newSaturation, newBrightness);
+    }
+
+    return colors;
+}
+
+// bakes getColorFromRamp for every 8-bit noise value into lut
+void rampLUT(const ColorRamp* ramp, Color lut[256]) {
+    for (i32 i = 0; i < 256; i++) {
+        lut[i] = getColorFromRamp(i, *ramp);
+    }
+}
+
+// the two noise layers colorPerlin blends together. the scale and both noise
+// seeds are drawn from rng.
+void planetNoiseDescs(enum NoiseType type, usize res, f32 customScale, Rng* rng,
+                      NoiseDesc* d1, NoiseDesc* d2) {
+    f32 scaleBase = 5;
+    scaleBase += rngRange(rng, -250, 500) / 100.0;
+
+    if (customScale != -1) {
+        scaleBase = customScale;
+    }
+
+    u64 s = rngNext(rng);
+    u64 s2 = rngNext(rng);
+
+    if (type == PERLIN) {
+        *d1 = noiseDefaults(PERLIN, s, scaleBase);
+        *d2 = noiseDefaults(PERLIN, s2, scaleBase * 2);
+    } else {
+        // the scale used to be raylib's cellular tile size in pixels
+        *d1 = noiseDefaults(CELLULAR, s, res / scaleBase);
+        *d2 = noiseDefaults(CELLULAR, s2, res / (scaleBase * 2));
+    }
+}
+
+// fills noise1 and noise2 with the layers described by planetNoiseDescs
+void genNoiseLayers(enum NoiseType type, usize res, f32 customScale, Rng* rng,
+                    u8* noise1, u8* noise2) {
+    NoiseDesc d1, d2;
+    planetNoiseDescs(type, res, customScale, rng, &d1, &d2);
+
+    noiseFieldU8(noise1, res, res, &d1);
+    noiseFieldU8(noise2, res, res, &d2);
+}
+
+/**
+ * Generates a Perlin noise-based image with colors applied from a
+ * ColorRamp.
+ *
+ * @param res          The resolution of the generated image (width and
+ * height).
+ * @param ramp         The ColorRamp to use for coloring the Perlin noise.
+ * @param customScale  The scale for Perlin noise; set to -1 to use the
+ * default scale.
+ * @param seed         Seed for the noise; the same seed gives the same image.
+ *
+ * @return An Image object generated based on the provided resolution, color
+ * ramp, and scale.
+ */
+Image colorPerlin(enum NoiseType type, usize res, ColorRamp ramp, f32 customScale,
+                  u64 seed) {
+    Image ret = imageAllocRGBA8(res, res);
+    u8* noise = malloc(res * res * 2);
+    if (ret.data == NULL || noise == NULL) {
+        perror("Error allocating memory in colorPerlin");
+        free(noise);
+        return ret;
+    }
+
+    Rng rng = rngInit(seed);
+    genNoiseLayers(type, res, customScale, &rng, noise, noise + res * res);
+
+    Color lut[256];
+    rampLUT(&ramp, lut);
+
+    Color* p = ret.data;
+    const u8* n1 = noise;
+    const u8* n2 = noise + res * res;
+
+    for (usize i = 0; i < res * res; i++) {
+        p[i] = lut[(n1[i] + n2[i]) / 2];
+    }
+
+    free(noise);
+    return ret;
+}
+
+/**
+ * Generates a finished planet surface in a single pass over the noise:
+ * equivalent to colorPerlin(PERLIN, res, ramp, -1, seed) followed by dither
+ * and cropToCircle, bit for bit, but written straight into the returned buffer.
+ */
+Image generatePlanetLand(usize res, ColorRamp ramp, i32 shadowOffsetx,
+                         i32 shadowOffsety, u64 seed) {
+    Image ret = imageAllocRGBA8(res, res);
+    u8* noise = malloc(res * res * 2);
+    if (ret.data == NULL || noise == NULL) {
+        perror("Error allocating memory in generatePlanetLand");
+        free(noise);
+        return ret;
+    }
+
+    Rng rng = rngInit(seed);
+    genNoiseLayers(PERLIN, res, -1, &rng, noise, noise + res * res);
+
+    Color lut[256];
+    rampLUT(&ramp, lut);
+
+    pixTerrain(ret.data, noise, noise + res * res, lut, res, res,
+               res / 2 + shadowOffsetx, res / 2 + shadowOffsety);
+
+    free(noise);
+    return ret;
+}
+
+// solid atmosphere disc with the same shadow as the land
+Image generatePlanetAtmosphere(usize res, Color color, i32 shadowOffsetx,
+                               i32 shadowOffsety) {
+    Image atm = GenImageColor(res, res, color);
+    pixShadeDisc(imageRGBA8(&atm), res, res, res / 2 + shadowOffsetx,
+                 res / 2 + shadowOffsety);
+    return atm;
+}
+
+void printTestRes(const char* txt, bool passed) {
+    // use ansi escape codes to color the output
+    if (passed) {
+        printf("\033[1;32m[PASSED]");
+        printf("\033[0m");
+        printf(" -- %s\n", txt);
+    } else {
+        printf("\033[1;31m[FAILED]");
+        printf("\033[0m");
+        printf(" -- %s\n", txt);
+    }
+}
+
+Color averageRamp(const ColorRamp* ramp) {
+    i32 rs = 0;
+    i32 gs = 0;
+    i32 bs = 0;
+
+    for (usize i = 0; i < ramp->len; i++) {
+        Color c = ramp->colors[i];
+        rs += c.r;
+        gs += c.g;
+        bs += c.b;
+    }
+
+    return (Color){rs / ramp->len, gs / ramp->len, bs / ramp->len, 255};
+}
+
+void planetTest() {
+    printf("\033[1;33m--------[RUNNING TESTS]--------]\n");
+    Color a = RED;
+    i32 h, s, v;
+    RGBtoHSV(a, &h, &s, &v);
+    Color b = HSVtoRGB(h, s, v);
+
+    bool passed =
+        (abs(a.r - b.r) < 5) && (abs(a.g - b.g) < 5) && (abs(a.b - b.b) < 5);
+
+    printTestRes("RGB to HSV to RGB", passed);
+}
+
+Color brightenColor(Color c) {
+    i32 max = fmax(c.r, fmax(c.g, c.b));
+    i32 diff = 255 - max;
+    return (Color){c.r + diff, c.g + diff, c.b + diff, c.a};
+}
+
+Color getRandomColor(Rng* rng) {
+    return (Color){rngRange(rng, 0, 255), rngRange(rng, 0, 255),
+                   rngRange(rng, 0, 255), 255};
+}
+
+// a fresh seed from raylib's generator, for planets that aren't regenerated
+u64 randomSeed() {
+    return ((u64)(u32)GetRandomValue(0, INT32_MAX) << 32) |
+           (u32)GetRandomValue(0, INT32_MAX);
+}
+
+void loadPlanetNames() {
+    FILE* file = fopen(PLANET_NAMES_PATH, "r");
+    if (file == NULL) {
+        perror("Error reading file");
+        return;
+    }
+
+    planetNames = malloc(sizeof(char*) * 500);
+    if (planetNames == NULL) {
+        perror("Error allocating memory in loadPlanetNames");
+        fclose(file);
+        return;
+    }
+
+    char* line = NULL;
+    size_t len = 0;
+    ssize_t read;
+    usize i = 0;
+
+    while ((read = getline(&line, &len, file)) != -1) {
+        planetNames[i] = malloc(sizeof(char) * PLANET_NAME_MAXLEN);
+        if (planetNames[i] == NULL) {
+            perror("Error allocating memory in loadPlanetNames");
+            fclose(file);
+            return;
+        }
+
+        strncpy(planetNames[i], line, PLANET_NAME_MAXLEN - 1);
+        planetNames[i][PLANET_NAME_MAXLEN - 1] = '\0';
+        i++;
+    }
+
+    planetNameCount = i;
+    fclose(file);
+    free(line);
+}
+
+const char* getPlanetName(Rng* rng) {
+    if (planetNames == NULL) {
+        loadPlanetNames();
+    }
+
+    if (planetNames == NULL || planetNameCount == 0) {
+        return NULL;
+    }
+
+    return planetNames[rngRange(rng, 0, planetNameCount - 1)];
+}
+
+Image generatePlanetBackground(ColorRamp palette, u64 seed) {
+    ProfileScope scope = profileBegin("planet background");
+    Image l1 = colorPerlin(PERLIN, PLANET_BG_RES, palette, 20, seed + 1);
+    Image l2 = colorPerlin(CELLULAR, PLANET_BG_RES, palette, 20, seed + 2);
+    Color* p1 = imageRGBA8(&l1);
+    pixAverage(p1, p1, imageRGBA8(&l2), PLANET_BG_RES * PLANET_BG_RES);
+
+    UnloadImage(l2);
+    profileEnd(scope);
+    return l1;
+}
+
+/**
+ * Derives everything about a planet from its seed except the layer pixels:
+ * palette, atmosphere colour, name and the description of its layers. Cheap,
+ * and safe to run on a worker thread. The land and atmosphere are left empty.
+ */
+void describePlanet(PlanetImages* out, u64 seed) {
+    Rng rng = rngInit(seed);
+    Color* cls =
+        generateHarmonizedColors(brightenColor(getRandomColor(&rng)), 6, 25, 1, 1);
+    ColorRamp ramp = createColorRampAuto(cls, 6, 255);
+    free(cls);
+
+    Color atmColor = brightenColor(averageRamp(&ramp));
+    atmColor.a = rngRange(&rng, 100, 200); // atmosphere density
+
+    out->seed = seed;
+    out->mapping = NULL;
+    out->mappingSize = 0;
+    out->palette = ramp;
+    out->atmColor = atmColor;
+    out->land = (Image){0};
+    out->atmosphere = (Image){0};
+    out->layers = (PlanetLayerDesc){.landSeed = rngNext(&rng),
+                                    .res = PLANET_RES,
+                                    .shadowOffsetx = 0,
+                                    .shadowOffsety = -PLANET_RES / 8,
+                                    .palette = ramp,
+                                    .atmColor = atmColor};
+
+    const char* name = getPlanetName(&rng);
+    if (name == NULL) {
+        name = "NAME ERROR";
+    }
+    strncpy(out->name, name, PLANET_NAME_MAXLEN);
+}
+
+// the CPU implementation of the layers; planetBackend.c has the shader one
+void generatePlanetLayers(const PlanetLayerDesc* d, Image* land, Image* atmosphere) {
+    ProfileScope scope = profileBegin("planet land");
+    *land = generatePlanetLand(d->res, d->palette, d->shadowOffsetx,
+                               d->shadowOffsety, d->landSeed);
+    profileEnd(scope);
+
+    scope = profileBegin("planet atmosphere");
+    *atmosphere = generatePlanetAtmosphere(d->res * ATMOSPHERE_SCALE, d->atmColor,
+                                           d->shadowOffsetx, d->shadowOffsety);
+    profileEnd(scope);
+}
+
+/**
+ * Generates every CPU side layer of a planet from its seed. Touches no raylib
+ * or flecs state, so it is safe to run on a worker thread.
+ */
+void generatePlanetImages(PlanetImages* out, u64 seed) {
+    ProfileScope scope = profileBegin("planet describe");
+    describePlanet(out, seed);
+    profileEnd(scope);
+    generatePlanetLayers(&out->layers, &out->land, &out->atmosphere);
+}
+
+// frees the layers, or drops the cache file mapping they point into
+void unloadPlanetImages(PlanetImages* imgs) {
+    if (imgs->mapping != NULL) {
+        munmap(imgs->mapping, imgs->mappingSize);
+        imgs->mapping = NULL;
+        return;
+    }
+
+    UnloadImage(imgs->land);
+    UnloadImage(imgs->atmosphere);
+}
@@ -0,0 +1,79 @@
+#include "integrate.h"
+#include <string.h>
+
+typedef f32 f32xN __attribute__((vector_size(INTEGRATE_LANES * sizeof(f32))));
+// one lane per entity of an f32xN, which holds x and y of each
+_Static_assert(INTEGRATE_LANES == 8, "the drag shuffle widens 4 lanes to 8");
+typedef f32 f32xE __attribute__((vector_size(INTEGRATE_LANES / 2 * sizeof(f32))));
+
+// columns carry no alignment guarantee, so go through memcpy, which becomes
+// an unaligned load or store. macros rather than functions, since passing a
+// 32 byte vector by value has a different ABI with and without AVX
+#define LOAD(v, p) memcpy(&(v), (p), sizeof(f32xN))
+#define STORE(p, v) memcpy((p), &(v), sizeof(f32xN))
+
+// a step with neither acceleration nor drag leaves velocity as it is, so it
+// only streams positions out; a quarter less memory traffic than the full step
+static void integrateVelocity(f32* restrict pos, const f32* restrict vel,
+                              usize n, f32 dt) {
+    const f32xN dtv = (f32xN){} + dt;
+    usize i = 0;
+
+    for (; i + INTEGRATE_LANES <= n; i += INTEGRATE_LANES) {
+        f32xN v, p;
+        LOAD(v, vel + i);
+        LOAD(p, pos + i);
+        p += v * dtv;
+        STORE(pos + i, p);
+    }
+
+    for (; i < n; i++) {
+        pos[i] += vel[i] * dt;
+    }
+}
+
+void integrate(f32* restrict pos, f32* restrict vel, const f32* restrict accel,
+               const f32* restrict drag, usize count, f32 dt) {
+    const usize n = count * 2;
+    if (accel == NULL && drag == NULL) {
+        integrateVelocity(pos, vel, n, dt);
+        return;
+    }
+
+    const f32xN dtv = (f32xN){} + dt;
+    const f32xE dte = (f32xE){} + dt;
+    usize i = 0;
+
+    for (; i + INTEGRATE_LANES <= n; i += INTEGRATE_LANES) {
+        f32xN v, p;
+        LOAD(v, vel + i);
+        LOAD(p, pos + i);
+
+        if (accel != NULL) {
+            f32xN a;
+            LOAD(a, accel + i);
+            v += a * dtv;
+        }
+
+        if (drag != NULL) {
+            // one coefficient per entity, divided as a whole vector and then
+            // widened to each entity's x and y lanes
+            f32xE d;
+            memcpy(&d, drag + i / 2, sizeof(d));
+            f32xE damp = 1.0f / (1.0f + d * dte);
+            v *= __builtin_shufflevector(damp, damp, 0, 0, 1, 1, 2, 2, 3, 3);
+        }
+
+        p += v * dtv;
+        STORE(vel + i, v);
+        STORE(pos + i, p);
+    }
+
+    for (; i < n; i++) {
+        f32 v = vel[i];
+        if (accel != NULL) v += accel[i] * dt;
+        if (drag != NULL) v *= 1.0f / (1.0f + drag[i / 2] * dt);
+        vel[i] = v;
+        pos[i] += v * dt;
+    }
+}
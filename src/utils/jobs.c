@@ -0,0 +1,134 @@
+#include "jobs.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#define JOBS_MAX_THREADS 64
+#define JOBS_QUEUE_START 64
+
+typedef struct {
+    JobFn fn;
+    void* arg;
+} Job;
+
+static pthread_t threads[JOBS_MAX_THREADS];
+static i32 threadCount = 0;
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t workReady = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t allDone = PTHREAD_COND_INITIALIZER;
+
+// ring buffer, grown when full
+static Job* queue = NULL;
+static usize queueCap = 0;
+static usize queueHead = 0;
+static usize queueLen = 0;
+
+static usize pending = 0; // queued plus running
+static bool stopping = false;
+
+static void* worker(void* arg) {
+    (void)arg;
+
+    pthread_mutex_lock(&lock);
+    while (true) {
+        while (queueLen == 0 && !stopping) {
+            pthread_cond_wait(&workReady, &lock);
+        }
+        if (queueLen == 0 && stopping) break;
+
+        Job job = queue[queueHead];
+        queueHead = (queueHead + 1) % queueCap;
+        queueLen--;
+
+        pthread_mutex_unlock(&lock);
+        job.fn(job.arg);
+        pthread_mutex_lock(&lock);
+
+        if (--pending == 0) pthread_cond_broadcast(&allDone);
+    }
+    pthread_mutex_unlock(&lock);
+    return NULL;
+}
+
+// threads <= 0 uses one worker per online core
+void jobsInit(i32 count) {
+    if (threadCount > 0) return;
+
+    if (count <= 0) count = sysconf(_SC_NPROCESSORS_ONLN);
+    count = MAX(1, MIN(count, JOBS_MAX_THREADS));
+    stopping = false;
+
+    for (i32 i = 0; i < count; i++) {
+        if (pthread_create(&threads[threadCount], NULL, worker, NULL) != 0) {
+            perror("Error creating worker thread in jobsInit");
+            break;
+        }
+        threadCount++;
+    }
+}
+
+// drops the jobs that haven't started, waits for the running ones, then joins
+// the workers. whoever submitted a dropped job still owns its arg
+void jobsShutdown(void) {
+    pthread_mutex_lock(&lock);
+    stopping = true;
+    pending -= queueLen;
+    queueLen = 0;
+    if (pending == 0) pthread_cond_broadcast(&allDone);
+    pthread_cond_broadcast(&workReady);
+    pthread_mutex_unlock(&lock);
+
+    for (i32 i = 0; i < threadCount; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    threadCount = 0;
+
+    free(queue);
+    queue = NULL;
+    queueCap = queueHead = queueLen = 0;
+}
+
+static bool growQueue(void) {
+    usize cap = queueCap == 0 ? JOBS_QUEUE_START : queueCap * 2;
+    Job* q = malloc(sizeof(Job) * cap);
+    if (q == NULL) return false;
+
+    for (usize i = 0; i < queueLen; i++) {
+        q[i] = queue[(queueHead + i) % queueCap];
+    }
+    free(queue);
+    queue = q;
+    queueCap = cap;
+    queueHead = 0;
+    return true;
+}
+
+// starts the pool on first use; runs fn inline if no thread could be started
+void jobsSubmit(JobFn fn, void* arg) {
+    if (threadCount == 0) jobsInit(0);
+
+    pthread_mutex_lock(&lock);
+    if (threadCount == 0 || (queueLen == queueCap && !growQueue())) {
+        pthread_mutex_unlock(&lock);
+        fn(arg);
+        return;
+    }
+
+    queue[(queueHead + queueLen) % queueCap] = (Job){fn, arg};
+    queueLen++;
+    pending++;
+    pthread_cond_signal(&workReady);
+    pthread_mutex_unlock(&lock);
+}
+
+// blocks until every job submitted so far has finished
+void jobsWait(void) {
+    pthread_mutex_lock(&lock);
+    while (pending > 0) {
+        pthread_cond_wait(&allDone, &lock);
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+i32 jobsThreadCount(void) { return threadCount; }
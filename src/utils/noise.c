@@ -0,0 +1,315 @@
+#include "noise.h"
+#include <math.h>
+#include <stdio.h>
+
+#define NOISE_MAX_OCTAVES 8
+#define WARP_OCTAVES 2
+
+// splitmix64
+u64 rngNext(Rng* rng) {
+    u64 z = (rng->state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+Rng rngInit(u64 seed) { return (Rng){seed}; }
+
+// inclusive on both ends, like GetRandomValue
+i32 rngRange(Rng* rng, i32 min, i32 max) {
+    if (max < min) return min;
+    u64 span = (u64)((i64)max - min) + 1;
+    return min + (i32)(rngNext(rng) % span);
+}
+
+NoiseDesc noiseDefaults(enum NoiseType type, u64 seed, f32 frequency) {
+    return (NoiseDesc){.type = type,
+                       .seed = seed,
+                       .frequency = frequency,
+                       .octaves = type == PERLIN ? 6 : 1,
+                       .lacunarity = 2,
+                       .gain = 0.5,
+                       .warp = 0};
+}
+
+// integer lattice hash, chosen so the same function is cheap in GLSL
+static inline u32 hash2(i32 x, i32 y, u32 seed) {
+    u32 h = seed ^ ((u32)x * 0x8da6b343u) ^ ((u32)y * 0xd8163841u);
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    h *= 0x846ca68bu;
+    h ^= h >> 16;
+    return h;
+}
+
+static const f32 gradX[8] = {1, -1, 1, -1, 1, -1, 0, 0};
+static const f32 gradY[8] = {1, 1, -1, -1, 0, 0, 1, -1};
+
+static inline i32 fastFloor(f32 x) {
+    i32 i = (i32)x;
+    return i - (x < i);
+}
+
+static inline f32 fade(f32 t) { return t * t * t * (t * (t * 6 - 15) + 10); }
+
+static inline f32 mix(f32 a, f32 b, f32 t) { return a + t * (b - a); }
+
+static inline f32 corner(i32 ix, i32 iy, u32 seed, f32 dx, f32 dy) {
+    u32 h = hash2(ix, iy, seed) & 7;
+    return gradX[h] * dx + gradY[h] * dy;
+}
+
+// 2D gradient noise, roughly in [-1, 1]
+static f32 perlin2(f32 x, f32 y, u32 seed) {
+    i32 ix = fastFloor(x);
+    i32 iy = fastFloor(y);
+    f32 dx = x - ix;
+    f32 dy = y - iy;
+
+    f32 n00 = corner(ix, iy, seed, dx, dy);
+    f32 n10 = corner(ix + 1, iy, seed, dx - 1, dy);
+    f32 n01 = corner(ix, iy + 1, seed, dx, dy - 1);
+    f32 n11 = corner(ix + 1, iy + 1, seed, dx - 1, dy - 1);
+
+    f32 u = fade(dx);
+    return mix(mix(n00, n10, u), mix(n01, n11, u), fade(dy));
+}
+
+// position of cell (ix, iy)'s one feature point, somewhere inside the cell
+static inline void featurePoint(i32 ix, i32 iy, u32 seed, f32* px, f32* py) {
+    u32 h = hash2(ix, iy, seed);
+    *px = ix + (h & 0xffff) / 65536.0f;
+    *py = iy + (h >> 16) / 65536.0f;
+}
+
+// distance to the nearest feature point, in cell units, clamped to [0, 1]
+static f32 cellular2(f32 x, f32 y, u32 seed) {
+    i32 ix = fastFloor(x);
+    i32 iy = fastFloor(y);
+    f32 best = 4;
+
+    for (i32 oy = -1; oy <= 1; oy++) {
+        for (i32 ox = -1; ox <= 1; ox++) {
+            f32 px, py;
+            featurePoint(ix + ox, iy + oy, seed, &px, &py);
+            f32 d2 = (px - x) * (px - x) + (py - y) * (py - y);
+            best = d2 < best ? d2 : best;
+        }
+    }
+
+    return fminf(sqrtf(best), 1);
+}
+
+static u32 octaveSeed(u64 seed, i32 octave) {
+    Rng r = rngInit(seed + (u64)octave * 0x632be59bd9b4e019ull);
+    return (u32)rngNext(&r);
+}
+
+// perlin follows raylib: the unnormalised sum is clamped to [-1, 1], then
+// remapped. cellular octaves are averaged so a single octave stays as is.
+static inline f32 finish(enum NoiseType type, f32 sum, f32 norm) {
+    if (type == PERLIN) {
+        sum = sum > 1 ? 1 : (sum < -1 ? -1 : sum);
+        return (sum + 1) / 2;
+    }
+    return sum / norm;
+}
+
+static f32 fbm(enum NoiseType type, f32 x, f32 y, const u32* seeds, i32 octaves,
+               f32 lacunarity, f32 gain) {
+    f32 sum = 0;
+    f32 amp = 1;
+    f32 norm = 0;
+
+    f32 freq = 1;
+
+    for (i32 o = 0; o < octaves; o++) {
+        if (type == PERLIN) {
+            sum += perlin2(x * freq, y * freq, seeds[o]) * amp;
+        } else {
+            sum += cellular2(x * freq, y * freq, seeds[o]) * amp;
+        }
+        norm += amp;
+        freq *= lacunarity;
+        amp *= gain;
+    }
+
+    return finish(type, sum, norm);
+}
+
+// the per octave lattice seeds of d, for evaluating the same noise elsewhere
+void noiseOctaveSeeds(const NoiseDesc* d, u32* seeds, i32 count) {
+    for (i32 o = 0; o < count; o++) {
+        seeds[o] = octaveSeed(d->seed, o);
+    }
+}
+
+typedef struct {
+    u32 seeds[NOISE_MAX_OCTAVES];
+    u32 warpSeeds[2][WARP_OCTAVES];
+    i32 octaves;
+} NoisePlan;
+
+static NoisePlan noisePlan(const NoiseDesc* d) {
+    NoisePlan p;
+    p.octaves = MAX(1, MIN(d->octaves, NOISE_MAX_OCTAVES));
+
+    for (i32 o = 0; o < NOISE_MAX_OCTAVES; o++) {
+        p.seeds[o] = octaveSeed(d->seed, o);
+    }
+    for (i32 o = 0; o < WARP_OCTAVES; o++) {
+        p.warpSeeds[0][o] = octaveSeed(d->seed ^ 0xa5a5a5a5a5a5a5a5ull, o);
+        p.warpSeeds[1][o] = octaveSeed(d->seed ^ 0x5a5a5a5a5a5a5a5aull, o);
+    }
+    return p;
+}
+
+static f32 samplePlan(const NoiseDesc* d, const NoisePlan* p, f32 x, f32 y) {
+    if (d->warp != 0) {
+        f32 wx = fbm(PERLIN, x, y, p->warpSeeds[0], WARP_OCTAVES, 2, 0.5);
+        f32 wy = fbm(PERLIN, x, y, p->warpSeeds[1], WARP_OCTAVES, 2, 0.5);
+        x += (wx * 2 - 1) * d->warp;
+        y += (wy * 2 - 1) * d->warp;
+    }
+
+    return fbm(d->type, x, y, p->seeds, p->octaves, d->lacunarity, d->gain);
+}
+
+// x and y are in feature units, i.e. already multiplied by the frequency
+f32 noiseSample(const NoiseDesc* d, f32 x, f32 y) {
+    NoisePlan p = noisePlan(d);
+    return samplePlan(d, &p, x + d->offsetx, y + d->offsety);
+}
+
+/*
+ * Row evaluation. Along a row only x changes, so the lattice hashes and the
+ * y terms are computed once per cell instead of once per pixel. Output is
+ * identical to calling samplePlan per pixel.
+ */
+
+static void perlinRow(f32* acc, i32 w, f32 x0, f32 step, f32 freq, f32 y,
+                      u32 seed, f32 amp) {
+    i32 iy = fastFloor(y);
+    f32 dy = y - iy;
+    f32 v = fade(dy);
+    i32 i = 0;
+
+    while (i < w) {
+        i32 ix = fastFloor((i * step + x0) * freq);
+        i32 end = i + 1;
+        while (end < w && fastFloor((end * step + x0) * freq) == ix) end++;
+
+        u32 h00 = hash2(ix, iy, seed) & 7;
+        u32 h10 = hash2(ix + 1, iy, seed) & 7;
+        u32 h01 = hash2(ix, iy + 1, seed) & 7;
+        u32 h11 = hash2(ix + 1, iy + 1, seed) & 7;
+        f32 g00 = gradX[h00], c00 = gradY[h00] * dy;
+        f32 g10 = gradX[h10], c10 = gradY[h10] * dy;
+        f32 g01 = gradX[h01], c01 = gradY[h01] * (dy - 1);
+        f32 g11 = gradX[h11], c11 = gradY[h11] * (dy - 1);
+
+        // branch free within a lattice cell so the compiler can vectorise it
+        for (; i < end; i++) {
+            f32 dx = (i * step + x0) * freq - ix;
+            f32 u = fade(dx);
+            f32 n0 = mix(g00 * dx + c00, g10 * (dx - 1) + c10, u);
+            f32 n1 = mix(g01 * dx + c01, g11 * (dx - 1) + c11, u);
+            acc[i] += mix(n0, n1, v) * amp;
+        }
+    }
+}
+
+static void cellularRow(f32* acc, i32 w, f32 x0, f32 step, f32 freq, f32 y,
+                        u32 seed, f32 amp) {
+    i32 iy = fastFloor(y);
+    i32 cell = 0;
+    f32 px[9], py[9];
+    bool primed = false;
+
+    for (i32 i = 0; i < w; i++) {
+        f32 x = (i * step + x0) * freq;
+        i32 ix = fastFloor(x);
+
+        if (!primed || ix != cell) {
+            cell = ix;
+            primed = true;
+            for (i32 k = 0; k < 9; k++) {
+                featurePoint(ix + k % 3 - 1, iy + k / 3 - 1, seed, &px[k], &py[k]);
+            }
+        }
+
+        f32 best = 4;
+        for (i32 k = 0; k < 9; k++) {
+            f32 d2 = (px[k] - x) * (px[k] - x) + (py[k] - y) * (py[k] - y);
+            best = d2 < best ? d2 : best;
+        }
+        acc[i] += fminf(sqrtf(best), 1) * amp;
+    }
+}
+
+static void fieldRow(f32* row, i32 w, i32 y, f32 step, const NoiseDesc* d,
+                     const NoisePlan* p) {
+    f32 fy = y * step + d->offsety;
+
+    if (d->warp != 0) {
+        for (i32 x = 0; x < w; x++) {
+            row[x] = samplePlan(d, p, x * step + d->offsetx, fy);
+        }
+        return;
+    }
+
+    f32 freq = 1;
+    f32 amp = 1;
+    f32 norm = 0;
+
+    for (i32 x = 0; x < w; x++) row[x] = 0;
+
+    for (i32 o = 0; o < p->octaves; o++) {
+        u32 seed = p->seeds[o];
+        if (d->type == PERLIN) {
+            perlinRow(row, w, d->offsetx, step, freq, fy * freq, seed, amp);
+        } else {
+            cellularRow(row, w, d->offsetx, step, freq, fy * freq, seed, amp);
+        }
+        norm += amp;
+        freq *= d->lacunarity;
+        amp *= d->gain;
+    }
+
+    for (i32 x = 0; x < w; x++) {
+        row[x] = finish(d->type, row[x], norm);
+    }
+}
+
+/**
+ * Fills a w x h field with values in [0, 1]. The field spans d->frequency
+ * features horizontally, with square pixels.
+ */
+void noiseFieldF32(f32* out, i32 w, i32 h, const NoiseDesc* d) {
+    NoisePlan p = noisePlan(d);
+    f32 step = d->frequency / w;
+
+    for (i32 y = 0; y < h; y++) {
+        fieldRow(&out[y * w], w, y, step, d, &p);
+    }
+}
+
+void noiseFieldU8(u8* out, i32 w, i32 h, const NoiseDesc* d) {
+    NoisePlan p = noisePlan(d);
+    f32 step = d->frequency / w;
+    f32* row = malloc(sizeof(f32) * w);
+    if (row == NULL) {
+        perror("Error allocating memory in noiseFieldU8");
+        return;
+    }
+
+    for (i32 y = 0; y < h; y++) {
+        fieldRow(row, w, y, step, d, &p);
+        for (i32 x = 0; x < w; x++) {
+            out[y * w + x] = row[x] * 255.0f;
+        }
+    }
+
+    free(row);
+}
@@ -0,0 +1,394 @@
+#include "pixel.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PIXEL_X86 1
+#endif
+
+// pixels per shadow chunk; keeps the factor scratch buffer on the stack
+#define SHADOW_CHUNK 64
+
+// returns the pixel buffer of img, converting it to RGBA8 first if needed
+Color* imageRGBA8(Image* img) {
+    if (img->format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8) {
+        ImageFormat(img, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    }
+    return (Color*)img->data;
+}
+
+// uninitialised RGBA8 image, freed with UnloadImage like any other
+Image imageAllocRGBA8(i32 w, i32 h) {
+    return (Image){.data = malloc(sizeof(Color) * w * h),
+                   .width = w,
+                   .height = h,
+                   .mipmaps = 1,
+                   .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+}
+
+// squared integer distances; the same test as sqrt(dx² + dy²) < circle
+static inline bool inCircle(i32 x, i32 y, i32 circle) {
+    i32 dx = x - circle;
+    i32 dy = y - circle;
+    return dx * dx + dy * dy < circle * circle;
+}
+
+static inline f32 shadowFactor(i32 x, i32 y, i32 cx, i32 cy, i32 w) {
+    i32 d = sqrtf(powf(x - cx, 2) + powf(y - cy, 2)) / 1.05;
+    f32 f = 1 - (d / (f32)((f32)w / 2));
+    return f < 0 ? 0 : f;
+}
+
+static inline Color darken(Color c, f32 f) {
+    return (Color){c.r * f, c.g * f, c.b * f, c.a};
+}
+
+/*
+ * Scalar reference kernels. The SIMD versions below must match these bit for
+ * bit: the average is a floor average and the shadow keeps the
+ * float -> double -> int truncation of the original dither.
+ */
+
+static void averageScalar(Color* dst, const Color* a, const Color* b, usize count) {
+    for (usize i = 0; i < count; i++) {
+        Color c1 = a[i];
+        Color c2 = b[i];
+        dst[i] = (Color){(c1.r + c2.r) / 2, (c1.g + c2.g) / 2, (c1.b + c2.b) / 2,
+                         (c1.a + c2.a) / 2};
+    }
+}
+
+static void shadowFactorsScalar(f32* out, i32 n, i32 x0, i32 y, i32 cx, i32 cy,
+                                i32 w) {
+    for (i32 i = 0; i < n; i++) {
+        out[i] = shadowFactor(x0 + i, y, cx, cy, w);
+    }
+}
+
+static void applyFactorsScalar(Color* px, const f32* f, i32 n) {
+    for (i32 i = 0; i < n; i++) {
+        px[i] = darken(px[i], f[i]);
+    }
+}
+
+#ifdef PIXEL_X86
+
+// floor((a + b) / 2) per byte, without widening
+static inline __m128i avgFloor128(__m128i a, __m128i b) {
+    __m128i half = _mm_and_si128(_mm_srli_epi16(_mm_xor_si128(a, b), 1),
+                                 _mm_set1_epi8(0x7f));
+    return _mm_add_epi8(_mm_and_si128(a, b), half);
+}
+
+static void averageSSE2(Color* dst, const Color* a, const Color* b, usize count) {
+    usize i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        _mm_storeu_si128((__m128i*)(dst + i), avgFloor128(va, vb));
+    }
+    averageScalar(dst + i, a + i, b + i, count - i);
+}
+
+static void shadowFactorsSSE2(f32* out, i32 n, i32 x0, i32 y, i32 cx, i32 cy,
+                              i32 w) {
+    const __m128 dy = _mm_set1_ps(y - cy);
+    const __m128 dy2 = _mm_mul_ps(dy, dy);
+    const __m128 half = _mm_set1_ps((f32)w / 2);
+    const __m128d scale = _mm_set1_pd(1.05);
+    i32 i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        i32 dx0 = x0 + i - cx;
+        __m128 dx = _mm_cvtepi32_ps(_mm_setr_epi32(dx0, dx0 + 1, dx0 + 2, dx0 + 3));
+        __m128 dist = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), dy2));
+
+        __m128d lo = _mm_div_pd(_mm_cvtps_pd(dist), scale);
+        __m128d hi = _mm_div_pd(_mm_cvtps_pd(_mm_movehl_ps(dist, dist)), scale);
+        __m128i d = _mm_unpacklo_epi64(_mm_cvttpd_epi32(lo), _mm_cvttpd_epi32(hi));
+
+        __m128 f = _mm_sub_ps(_mm_set1_ps(1), _mm_div_ps(_mm_cvtepi32_ps(d), half));
+        _mm_storeu_ps(out + i, _mm_max_ps(f, _mm_setzero_ps()));
+    }
+    shadowFactorsScalar(out + i, n - i, x0 + i, y, cx, cy, w);
+}
+
+static void applyFactorsSSE2(Color* px, const f32* f, i32 n) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alpha = _mm_set1_epi32(0xff000000);
+    i32 i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        __m128i src = _mm_loadu_si128((const __m128i*)(px + i));
+        __m128 fs = _mm_loadu_ps(f + i);
+        __m128i lo16 = _mm_unpacklo_epi8(src, zero);
+        __m128i hi16 = _mm_unpackhi_epi8(src, zero);
+
+        __m128i c[4] = {
+            _mm_unpacklo_epi16(lo16, zero), _mm_unpackhi_epi16(lo16, zero),
+            _mm_unpacklo_epi16(hi16, zero), _mm_unpackhi_epi16(hi16, zero)};
+        __m128 k[4] = {
+            _mm_shuffle_ps(fs, fs, 0x00), _mm_shuffle_ps(fs, fs, 0x55),
+            _mm_shuffle_ps(fs, fs, 0xaa), _mm_shuffle_ps(fs, fs, 0xff)};
+        for (i32 j = 0; j < 4; j++) {
+            c[j] = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(c[j]), k[j]));
+        }
+
+        __m128i out = _mm_packus_epi16(_mm_packs_epi32(c[0], c[1]),
+                                       _mm_packs_epi32(c[2], c[3]));
+        out = _mm_or_si128(_mm_andnot_si128(alpha, out), _mm_and_si128(alpha, src));
+        _mm_storeu_si128((__m128i*)(px + i), out);
+    }
+    applyFactorsScalar(px + i, f + i, n - i);
+}
+
+static __attribute__((target("avx2"))) void
+averageAVX2(Color* dst, const Color* a, const Color* b, usize count) {
+    const __m256i mask = _mm256_set1_epi8(0x7f);
+    usize i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+        __m256i half =
+            _mm256_and_si256(_mm256_srli_epi16(_mm256_xor_si256(va, vb), 1), mask);
+        __m256i avg = _mm256_add_epi8(_mm256_and_si256(va, vb), half);
+        _mm256_storeu_si256((__m256i*)(dst + i), avg);
+    }
+    averageSSE2(dst + i, a + i, b + i, count - i);
+}
+
+static __attribute__((target("avx2"))) void
+shadowFactorsAVX2(f32* out, i32 n, i32 x0, i32 y, i32 cx, i32 cy, i32 w) {
+    const __m256 dy = _mm256_set1_ps(y - cy);
+    const __m256 dy2 = _mm256_mul_ps(dy, dy);
+    const __m256 half = _mm256_set1_ps((f32)w / 2);
+    const __m256d scale = _mm256_set1_pd(1.05);
+    const __m256i iota = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    i32 i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m256i xs = _mm256_add_epi32(_mm256_set1_epi32(x0 + i - cx), iota);
+        __m256 dx = _mm256_cvtepi32_ps(xs);
+        __m256 dist = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), dy2));
+
+        __m256d lo = _mm256_cvtps_pd(_mm256_castps256_ps128(dist));
+        __m256d hi = _mm256_cvtps_pd(_mm256_extractf128_ps(dist, 1));
+        __m128i dlo = _mm256_cvttpd_epi32(_mm256_div_pd(lo, scale));
+        __m128i dhi = _mm256_cvttpd_epi32(_mm256_div_pd(hi, scale));
+        __m256i d = _mm256_set_m128i(dhi, dlo);
+
+        __m256 f = _mm256_sub_ps(_mm256_set1_ps(1),
+                                 _mm256_div_ps(_mm256_cvtepi32_ps(d), half));
+        _mm256_storeu_ps(out + i, _mm256_max_ps(f, _mm256_setzero_ps()));
+    }
+    shadowFactorsSSE2(out + i, n - i, x0 + i, y, cx, cy, w);
+}
+
+static __attribute__((target("avx2"))) void applyFactorsAVX2(Color* px,
+                                                             const f32* f, i32 n) {
+    const __m256i alpha = _mm256_set1_epi32(0xff000000);
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    i32 i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m256i src = _mm256_loadu_si256((const __m256i*)(px + i));
+        __m256 fs = _mm256_loadu_ps(f + i);
+        __m256i c[4];
+
+        // two pixels per register: channels of pixel 2j in the low half,
+        // pixel 2j + 1 in the high half
+        for (i32 j = 0; j < 4; j++) {
+            __m128i two = _mm_loadl_epi64((const __m128i*)(px + i + j * 2));
+            __m256i idx = _mm256_setr_epi32(j * 2, j * 2, j * 2, j * 2, j * 2 + 1,
+                                            j * 2 + 1, j * 2 + 1, j * 2 + 1);
+            __m256 k = _mm256_permutevar8x32_ps(fs, idx);
+            __m256 ch = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(two));
+            c[j] = _mm256_cvttps_epi32(_mm256_mul_ps(ch, k));
+        }
+
+        // packs work per 128 bit lane, leaving pixels as 0 2 4 6 | 1 3 5 7
+        __m256i out = _mm256_packus_epi16(_mm256_packs_epi32(c[0], c[1]),
+                                          _mm256_packs_epi32(c[2], c[3]));
+        out = _mm256_permutevar8x32_epi32(out, order);
+        out = _mm256_or_si256(_mm256_andnot_si256(alpha, out),
+                              _mm256_and_si256(alpha, src));
+        _mm256_storeu_si256((__m256i*)(px + i), out);
+    }
+    applyFactorsSSE2(px + i, f + i, n - i);
+}
+
+// cpu features are resolved by libgcc at startup; this is just a flag read
+static bool hasAVX2(void) { return __builtin_cpu_supports("avx2"); }
+
+#endif
+
+// dst may alias a or b
+void pixAverage(Color* dst, const Color* a, const Color* b, usize count) {
+#ifdef PIXEL_X86
+    if (hasAVX2()) {
+        averageAVX2(dst, a, b, count);
+    } else {
+        averageSSE2(dst, a, b, count);
+    }
+#else
+    averageScalar(dst, a, b, count);
+#endif
+}
+
+static void shadowFactors(f32* out, i32 n, i32 x0, i32 y, i32 cx, i32 cy,
+                          i32 w) {
+#ifdef PIXEL_X86
+    if (hasAVX2()) {
+        shadowFactorsAVX2(out, n, x0, y, cx, cy, w);
+    } else {
+        shadowFactorsSSE2(out, n, x0, y, cx, cy, w);
+    }
+#else
+    shadowFactorsScalar(out, n, x0, y, cx, cy, w);
+#endif
+}
+
+static void applyFactors(Color* px, const f32* f, i32 n) {
+#ifdef PIXEL_X86
+    if (hasAVX2()) {
+        applyFactorsAVX2(px, f, n);
+    } else {
+        applyFactorsSSE2(px, f, n);
+    }
+#else
+    applyFactorsScalar(px, f, n);
+#endif
+}
+
+static ShadeTable shadeTables[SHADE_TABLE_MAX];
+static usize shadeTableCount = 0;
+static pthread_mutex_t shadeTableLock = PTHREAD_MUTEX_INITIALIZER;
+
+static const ShadeTable* findOrBuildShadeTable(i32 w, i32 h, i32 cx, i32 cy) {
+    for (usize i = 0; i < shadeTableCount; i++) {
+        ShadeTable* t = &shadeTables[i];
+        if (t->w == w && t->h == h && t->cx == cx && t->cy == cy) return t;
+    }
+
+    if (shadeTableCount == SHADE_TABLE_MAX) return NULL;
+
+    f32* falloff = malloc(sizeof(f32) * w * h);
+    u8* inside = malloc(sizeof(u8) * w * h);
+    if (falloff == NULL || inside == NULL) {
+        perror("Error allocating memory in pixShadeTable");
+        free(falloff);
+        free(inside);
+        return NULL;
+    }
+
+    i32 circle = w / 2;
+    for (i32 y = 0; y < h; y++) {
+        shadowFactors(&falloff[y * w], w, 0, y, cx, cy, w);
+        for (i32 x = 0; x < w; x++) {
+            inside[y * w + x] = inCircle(x, y, circle);
+        }
+    }
+
+    ShadeTable* t = &shadeTables[shadeTableCount++];
+    *t = (ShadeTable){w, h, cx, cy, falloff, inside};
+    return t;
+}
+
+/**
+ * Returns the falloff and circle mask tables for a w x h image shadowed from
+ * (cx, cy), building them on first use. Tables live until pixFreeShadeTables.
+ * Returns NULL once the cache is full; callers then compute per pixel.
+ * Safe to call from worker threads; entries never move once built.
+ */
+const ShadeTable* pixShadeTable(i32 w, i32 h, i32 cx, i32 cy) {
+    pthread_mutex_lock(&shadeTableLock);
+    const ShadeTable* t = findOrBuildShadeTable(w, h, cx, cy);
+    pthread_mutex_unlock(&shadeTableLock);
+    return t;
+}
+
+void pixFreeShadeTables(void) {
+    pthread_mutex_lock(&shadeTableLock);
+    for (usize i = 0; i < shadeTableCount; i++) {
+        free(shadeTables[i].falloff);
+        free(shadeTables[i].inside);
+    }
+    shadeTableCount = 0;
+    pthread_mutex_unlock(&shadeTableLock);
+}
+
+// the mask alone; going through pixShadeTable would build a falloff table
+// nothing reads and take up one of the cache's slots
+void pixCropToCircle(Color* px, i32 w, i32 h) {
+    i32 circle = w / 2;
+
+    for (i32 y = 0; y < h; y++) {
+        for (i32 x = 0; x < w; x++) {
+            if (!inCircle(x, y, circle)) px[y * w + x] = BLANK;
+        }
+    }
+}
+
+// darken pixels the futher they are from the shadow circle at (cx, cy)
+void pixShadow(Color* px, i32 w, i32 h, i32 cx, i32 cy) {
+    const ShadeTable* t = pixShadeTable(w, h, cx, cy);
+    if (t != NULL) {
+        applyFactors(px, t->falloff, w * h);
+        return;
+    }
+
+    f32 f[SHADOW_CHUNK];
+    for (i32 y = 0; y < h; y++) {
+        for (i32 x = 0; x < w; x += SHADOW_CHUNK) {
+            i32 n = MIN(SHADOW_CHUNK, w - x);
+            shadowFactors(f, n, x, y, cx, cy, w);
+            applyFactors(&px[y * w + x], f, n);
+        }
+    }
+}
+
+// pixShadow followed by pixCropToCircle, in one pass
+void pixShadeDisc(Color* px, i32 w, i32 h, i32 cx, i32 cy) {
+    const ShadeTable* t = pixShadeTable(w, h, cx, cy);
+    i32 circle = w / 2;
+
+    for (i32 i = 0; i < w * h; i++) {
+        i32 x = i % w;
+        i32 y = i / w;
+
+        if (t ? t->inside[i] : inCircle(x, y, circle)) {
+            f32 f = t ? t->falloff[i] : shadowFactor(x, y, cx, cy, w);
+            px[i] = darken(px[i], f);
+        } else {
+            px[i] = BLANK;
+        }
+    }
+}
+
+/**
+ * Fused terrain stage: averages two 8-bit noise fields, maps the result
+ * through a 256 entry color lookup table, applies the shadow falloff and the
+ * circular alpha mask, writing the result to dst.
+ */
+void pixTerrain(Color* dst, const u8* n1, const u8* n2, const Color* lut, i32 w,
+                i32 h, i32 cx, i32 cy) {
+    const ShadeTable* t = pixShadeTable(w, h, cx, cy);
+    i32 circle = w / 2;
+
+    for (i32 i = 0; i < w * h; i++) {
+        i32 x = i % w;
+        i32 y = i / w;
+
+        if (!(t ? t->inside[i] : inCircle(x, y, circle))) {
+            dst[i] = BLANK;
+            continue;
+        }
+
+        Color c = lut[(n1[i] + n2[i]) / 2];
+        f32 f = t ? t->falloff[i] : shadowFactor(x, y, cx, cy, w);
+        dst[i] = darken(c, f);
+    }
+}
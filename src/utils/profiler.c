@@ -0,0 +1,207 @@
+#include "profiler.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+    const char* name;
+    f32 samples[PROFILER_WINDOW]; // ms
+    usize count;                  // total ever recorded, the ring wraps
+} ProfileEntry;
+
+// a counter event holds a system's time for the frame ending at start
+typedef struct {
+    const char* name;
+    u64 start;
+    u64 dur;
+    i32 tid;
+    bool counter;
+} ProfileEvent;
+
+atomic_bool profilerOn = false;
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static ProfileEntry entries[PROFILER_MAX_ENTRIES];
+static usize entryCount = 0;
+
+static ProfileEvent* events = NULL;
+static usize eventCount = 0;
+static u64 traceStart = 0;
+
+static atomic_int nextTid = 0;
+static _Thread_local i32 tid = -1;
+
+u64 profileNow(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (u64)t.tv_sec * 1000000000ull + t.tv_nsec;
+}
+
+// callers hold lock
+static ProfileEntry* findEntry(const char* name) {
+    for (usize i = 0; i < entryCount; i++) {
+        if (entries[i].name == name || !strcmp(entries[i].name, name)) {
+            return &entries[i];
+        }
+    }
+    if (entryCount == PROFILER_MAX_ENTRIES) return NULL;
+
+    ProfileEntry* e = &entries[entryCount++];
+    *e = (ProfileEntry){.name = name};
+    return e;
+}
+
+// callers hold lock
+static void addSample(ProfileEntry* e, u64 dur) {
+    if (e == NULL) return;
+    e->samples[e->count++ % PROFILER_WINDOW] = dur / 1e6f;
+}
+
+// callers hold lock
+static void addEvent(const char* name, u64 start, u64 dur, bool counter) {
+    if (events == NULL || eventCount == PROFILER_MAX_EVENTS) return;
+    if (tid < 0) tid = atomic_fetch_add(&nextTid, 1);
+    events[eventCount++] = (ProfileEvent){name, start, dur, tid, counter};
+}
+
+void profileRecord(const char* name, u64 start, u64 end) {
+    pthread_mutex_lock(&lock);
+    addSample(findEntry(name), end - start);
+    addEvent(name, start, end - start, false);
+    pthread_mutex_unlock(&lock);
+}
+
+// the flag profileBegin checks; profilerEnable also switches flecs' timing
+void profilerSetOn(bool on) { atomic_store(&profilerOn, on); }
+
+// starts logging trace events, returns false if the buffer can't be had
+bool profilerTrace(void) {
+    pthread_mutex_lock(&lock);
+    if (events == NULL) {
+        events = malloc(sizeof(ProfileEvent) * PROFILER_MAX_EVENTS);
+    }
+    if (events == NULL) perror("Error allocating memory in profilerTrace");
+    traceStart = profileNow();
+    eventCount = 0;
+    pthread_mutex_unlock(&lock);
+    return events != NULL;
+}
+
+// one sample of a system's time, taken at the end of the frame
+void profileSystem(const char* name, u64 frameEnd, u64 dur) {
+    pthread_mutex_lock(&lock);
+    addSample(findEntry(name), dur);
+    addEvent(name, frameEnd, dur, true);
+    pthread_mutex_unlock(&lock);
+}
+
+static int compareF32(const void* a, const void* b) {
+    f32 x = *(const f32*)a;
+    f32 y = *(const f32*)b;
+    return (x > y) - (x < y);
+}
+
+// p50 and p99 of what is in the entry's window
+static void percentiles(const ProfileEntry* e, f32* p50, f32* p99) {
+    f32 sorted[PROFILER_WINDOW];
+    usize n = MIN(e->count, PROFILER_WINDOW);
+    memcpy(sorted, e->samples, n * sizeof(f32));
+    qsort(sorted, n, sizeof(f32), compareF32);
+
+    *p50 = n ? sorted[n / 2] : 0;
+    *p99 = n ? sorted[MIN(n - 1, n * 99 / 100)] : 0;
+}
+
+// fills out with up to max entries' names and percentiles, returns how many
+usize profilerStats(ProfileStat* out, usize max) {
+    pthread_mutex_lock(&lock);
+    usize n = MIN(entryCount, max);
+    for (usize i = 0; i < n; i++) {
+        out[i] = (ProfileStat){.name = entries[i].name, .samples = entries[i].count};
+        percentiles(&entries[i], &out[i].p50, &out[i].p99);
+    }
+    pthread_mutex_unlock(&lock);
+    return n;
+}
+
+/**
+ * Writes the logged events as Chrome trace JSON. Scopes become complete
+ * events on the thread that ran them, and each frame's system times one
+ * stacked counter, since flecs only reports them as totals.
+ */
+bool profilerWriteTrace(const char* path) {
+    FILE* f = fopen(path, "w");
+    if (f == NULL) {
+        perror("Error opening trace in profilerWriteTrace");
+        return false;
+    }
+
+    pthread_mutex_lock(&lock);
+    fprintf(f, "{\"traceEvents\":[\n");
+    for (usize i = 0; i < eventCount;) {
+        const ProfileEvent* ev = &events[i];
+        f64 ts = (ev->start - traceStart) / 1e3;
+        if (i > 0) fprintf(f, ",\n");
+
+        if (!ev->counter) {
+            fprintf(f,
+                    "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,"
+                    "\"ts\":%.3f,\"dur\":%.3f}",
+                    ev->name, ev->tid, ts, ev->dur / 1e3);
+            i++;
+            continue;
+        }
+
+        // a frame's system times were logged back to back with the same start
+        fprintf(f,
+                "{\"name\":\"systems\",\"ph\":\"C\",\"pid\":0,\"ts\":%.3f,"
+                "\"args\":{",
+                ts);
+        u64 frameEnd = ev->start;
+        for (usize j = i; i < eventCount && events[i].counter &&
+                          events[i].start == frameEnd;
+             i++) {
+            fprintf(f, "%s\"%s\":%.3f", i > j ? "," : "", events[i].name,
+                    events[i].dur / 1e6);
+        }
+        fprintf(f, "}}");
+    }
+    fprintf(f, "\n]}\n");
+    if (eventCount == PROFILER_MAX_EVENTS) {
+        fprintf(stderr, "trace buffer filled, later events were dropped\n");
+    }
+    pthread_mutex_unlock(&lock);
+
+    fclose(f);
+    return true;
+}
+
+// one row per entry with the percentiles the overlay shows
+bool profilerWriteCsv(const char* path) {
+    FILE* f = fopen(path, "w");
+    if (f == NULL) {
+        perror("Error opening csv in profilerWriteCsv");
+        return false;
+    }
+
+    ProfileStat stats[PROFILER_MAX_ENTRIES];
+    usize n = profilerStats(stats, PROFILER_MAX_ENTRIES);
+
+    fprintf(f, "name,samples,p50_ms,p99_ms\n");
+    for (usize i = 0; i < n; i++) {
+        fprintf(f, "%s,%zu,%.4f,%.4f\n", stats[i].name, stats[i].samples,
+                stats[i].p50, stats[i].p99);
+    }
+
+    fclose(f);
+    return true;
+}
+
+void profilerShutdown(void) {
+    atomic_store(&profilerOn, false);
+    free(events);
+    events = NULL;
+    eventCount = 0;
+}
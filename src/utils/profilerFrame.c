@@ -0,0 +1,127 @@
+#include "profiler.h"
+#include "raylib.h"
+
+// The game side of the profiler: flecs system timings and the overlay. Kept
+// apart from profiler.c so the benchmarks can use scopes without flecs or GL.
+
+#define PROFILER_FONT_SIZE 10
+#define PROFILER_ROW_HEIGHT 12
+
+// a system whose callback was swapped for timedSystem, which times the real one
+typedef struct {
+    ecs_entity_t system;
+    ecs_iter_action_t action;
+    const char* name;
+    atomic_uint_least64_t spent; // ns since the last frame, summed over threads
+} TimedSystem;
+
+static ecs_world_t* timedWorld = NULL;
+static TimedSystem timed[PROFILER_MAX_ENTRIES];
+static usize timedCount = 0;
+static u64 lastFrameEnd = 0;
+static bool primed = false; // whether spent covers a whole frame
+
+// runs once per matched table, on whichever thread the table went to
+static void timedSystem(ecs_iter_t* it) {
+    TimedSystem* t = it->callback_ctx;
+    if (!atomic_load_explicit(&profilerOn, memory_order_relaxed)) {
+        t->action(it);
+        return;
+    }
+
+    u64 start = profileNow();
+    t->action(it);
+    atomic_fetch_add_explicit(&t->spent, profileNow() - start,
+                              memory_order_relaxed);
+}
+
+static bool isBuiltin(ecs_world_t* world, ecs_entity_t e) {
+    for (; e != 0; e = ecs_get_parent(world, e)) {
+        if (e == EcsFlecs) return true;
+    }
+    return false;
+}
+
+/**
+ * Routes every game system made since the last call through timedSystem.
+ * Timing the callbacks with the u64 clock, rather than diffing flecs'
+ * time_spent, keeps cheap systems exact: that total is a float that is never
+ * reset while the explorer reads it, so after a while its steps are
+ * microseconds wide.
+ */
+static void wrapSystems(ecs_world_t* world) {
+    if (world != timedWorld) timedCount = 0;
+    timedWorld = world;
+
+    ecs_iter_t it = ecs_each_id(world, EcsSystem);
+    while (ecs_each_next(&it)) {
+        for (i32 i = 0; i < it.count; i++) {
+            ecs_entity_t e = it.entities[i];
+            const ecs_system_t* sys = ecs_system_get(world, e);
+            const char* name = ecs_get_name(world, e);
+            if (sys == NULL || name == NULL || sys->action == NULL ||
+                sys->action == timedSystem || isBuiltin(world, e)) {
+                continue;
+            }
+            if (timedCount == PROFILER_MAX_ENTRIES) {
+                ecs_iter_fini(&it);
+                return;
+            }
+
+            TimedSystem* t = &timed[timedCount++];
+            t->system = e;
+            t->action = sys->action;
+            t->name = name;
+            atomic_init(&t->spent, 0);
+            ecs_system(world,
+                       {.entity = e, .callback = timedSystem, .callback_ctx = t});
+        }
+    }
+}
+
+void profilerEnable(ecs_world_t* world, bool enable) {
+    if (enable) wrapSystems(world);
+    for (usize i = 0; i < timedCount; i++) {
+        atomic_store(&timed[i].spent, 0);
+    }
+
+    profilerSetOn(enable);
+    lastFrameEnd = enable ? profileNow() : 0;
+    primed = false;
+}
+
+// samples every system's time since the last call, plus the frame as a whole
+void profilerEndFrame(ecs_world_t* world) {
+    (void)world;
+    if (!atomic_load_explicit(&profilerOn, memory_order_relaxed)) return;
+    u64 now = profileNow();
+    profileRecord("frame", lastFrameEnd, now);
+    lastFrameEnd = now;
+
+    for (usize i = 0; i < timedCount; i++) {
+        u64 dur = atomic_exchange_explicit(&timed[i].spent, 0, memory_order_relaxed);
+        if (primed) profileSystem(timed[i].name, now, dur);
+    }
+    primed = true;
+}
+
+// drawn straight to the window, call between drawScaledWindow and EndDrawing
+void profilerDrawOverlay(void) {
+    if (!atomic_load_explicit(&profilerOn, memory_order_relaxed)) return;
+
+    ProfileStat stats[PROFILER_MAX_ENTRIES];
+    usize n = profilerStats(stats, PROFILER_MAX_ENTRIES);
+
+    i32 x = 8;
+    i32 y = 8;
+    DrawRectangle(x - 4, y - 4, 260, PROFILER_ROW_HEIGHT * (n + 1) + 8,
+                  Fade(BLACK, 0.75f));
+    DrawText("ms             p50      p99", x, y, PROFILER_FONT_SIZE, GRAY);
+
+    for (usize i = 0; i < n; i++) {
+        y += PROFILER_ROW_HEIGHT;
+        DrawText(stats[i].name, x, y, PROFILER_FONT_SIZE, WHITE);
+        DrawText(TextFormat("%8.3f %8.3f", stats[i].p50, stats[i].p99), x + 130, y,
+                 PROFILER_FONT_SIZE, WHITE);
+    }
+}
@@ -0,0 +1,152 @@
+#include "replay.h"
+#include <stdio.h>
+#include <string.h>
+
+typedef struct {
+    u32 magic;
+    u32 version;
+    u32 maxKeys;
+    u32 randomSeed;
+    u64 universeSeed;
+} ReplayHeader;
+
+// followed by keyChanges then keysPressed u16 key codes
+typedef struct {
+    f32 frameTime;
+    v2 mouse;
+    f32 scale;
+    u8 buttonsDown;
+    u8 buttonsPressed;
+    u8 buttonsReleased;
+    u8 keyChanges;
+    u8 keysPressed;
+} ReplayFrame;
+
+static FILE* file;
+static ReplayMode mode = REPLAY_OFF;
+static bool finished = false;
+// keysDown as of the last frame written or read
+static u64 lastDown[INPUT_KEY_WORDS];
+
+static bool keyBit(const u64* bits, i32 key) {
+    return (bits[key / 64] >> (key % 64)) & 1;
+}
+
+// appends the keys set in bits to out, returns how many. u8 counts cap a
+// frame at 255, far more than a keyboard reports at once
+static u8 keyList(const u64* bits, u16* out) {
+    u8 n = 0;
+    for (i32 key = 0; key < INPUT_MAX_KEYS && n < UINT8_MAX; key++) {
+        if (keyBit(bits, key)) out[n++] = key;
+    }
+    return n;
+}
+
+static bool openLog(const char* path, const char* fmode, ReplayMode m) {
+    replayClose();
+    file = fopen(path, fmode);
+    if (file == NULL) {
+        perror("Error opening replay in openLog");
+        return false;
+    }
+    mode = m;
+    finished = false;
+    memset(lastDown, 0, sizeof(lastDown));
+    return true;
+}
+
+bool replayRecord(const char* path, ReplaySeeds seeds) {
+    if (!openLog(path, "wb", REPLAY_RECORDING)) return false;
+
+    ReplayHeader h = {.magic = REPLAY_MAGIC,
+                      .version = REPLAY_VERSION,
+                      .maxKeys = INPUT_MAX_KEYS,
+                      .randomSeed = seeds.randomSeed,
+                      .universeSeed = seeds.universeSeed};
+    fwrite(&h, sizeof(h), 1, file);
+    return true;
+}
+
+bool replayPlay(const char* path, ReplaySeeds* seeds) {
+    if (!openLog(path, "rb", REPLAY_PLAYING)) return false;
+
+    ReplayHeader h;
+    if (fread(&h, sizeof(h), 1, file) != 1 || h.magic != REPLAY_MAGIC ||
+        h.version != REPLAY_VERSION || h.maxKeys != INPUT_MAX_KEYS) {
+        fprintf(stderr, "%s is not a replay this build can play\n", path);
+        replayClose();
+        return false;
+    }
+    seeds->randomSeed = h.randomSeed;
+    seeds->universeSeed = h.universeSeed;
+    return true;
+}
+
+ReplayMode replayMode(void) { return mode; }
+
+// true once a playback has run out of frames
+bool replayFinished(void) { return finished; }
+
+void replayWrite(const InputState* in) {
+    if (mode != REPLAY_RECORDING) return;
+
+    u64 changed[INPUT_KEY_WORDS];
+    for (usize i = 0; i < INPUT_KEY_WORDS; i++) {
+        changed[i] = in->keysDown[i] ^ lastDown[i];
+    }
+    memcpy(lastDown, in->keysDown, sizeof(lastDown));
+
+    u16 keys[2 * UINT8_MAX];
+    ReplayFrame f = {.frameTime = in->frameTime,
+                     .mouse = in->mouse,
+                     .scale = in->scale,
+                     .buttonsDown = in->buttonsDown,
+                     .buttonsPressed = in->buttonsPressed,
+                     .buttonsReleased = in->buttonsReleased};
+    f.keyChanges = keyList(changed, keys);
+    f.keysPressed = keyList(in->keysPressed, keys + f.keyChanges);
+
+    fwrite(&f, sizeof(f), 1, file);
+    fwrite(keys, sizeof(u16), f.keyChanges + f.keysPressed, file);
+}
+
+// fills in with the next recorded frame, false once there are none left
+bool replayRead(InputState* in) {
+    if (mode != REPLAY_PLAYING || finished) return false;
+
+    ReplayFrame f;
+    u16 keys[2 * UINT8_MAX];
+    if (fread(&f, sizeof(f), 1, file) != 1 ||
+        fread(keys, sizeof(u16), f.keyChanges + f.keysPressed, file) !=
+            (usize)(f.keyChanges + f.keysPressed)) {
+        finished = true;
+        return false;
+    }
+
+    memset(in, 0, sizeof(*in));
+    for (i32 i = 0; i < f.keyChanges + f.keysPressed; i++) {
+        if (keys[i] >= INPUT_MAX_KEYS) continue;
+        u64 bit = 1ull << (keys[i] % 64);
+
+        if (i < f.keyChanges) {
+            lastDown[keys[i] / 64] ^= bit;
+        } else {
+            in->keysPressed[keys[i] / 64] |= bit;
+        }
+    }
+    memcpy(in->keysDown, lastDown, sizeof(lastDown));
+
+    in->buttonsDown = f.buttonsDown;
+    in->buttonsPressed = f.buttonsPressed;
+    in->buttonsReleased = f.buttonsReleased;
+    in->mouse = f.mouse;
+    in->scale = f.scale;
+    in->frameTime = f.frameTime;
+    return true;
+}
+
+void replayClose(void) {
+    if (file != NULL) fclose(file);
+    file = NULL;
+    mode = REPLAY_OFF;
+}
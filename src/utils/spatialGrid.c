@@ -0,0 +1,293 @@
+#include "spatialGrid.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define GRID_START 64
+
+typedef struct {
+    u64 key; // 0 while the item is on the free list
+    Rect box;
+    i32 x0, y0, x1, y1; // covered cell range, inclusive
+} GridItem;
+
+typedef struct {
+    i32* items;
+    i32 len;
+    i32 cap;
+} GridBucket;
+
+struct SpatialGrid {
+    f32 cellSize;
+
+    // items keep their index for life, so buckets can refer to them by index
+    GridItem* items;
+    i32 itemLen;
+    i32 itemCap;
+    i32* freeList;
+    i32 freeLen;
+
+    // key -> item index + 1, open addressing with linear probing
+    u64* mapKeys;
+    i32* mapItems;
+    usize mapCap;
+    usize mapLen;
+
+    GridBucket buckets[GRID_BUCKETS];
+};
+
+static inline u64 hashKey(u64 k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdull;
+    k ^= k >> 33;
+    return k;
+}
+
+static inline u32 cellBucket(i32 x, i32 y) {
+    u32 h = ((u32)x * 0x8da6b343u) ^ ((u32)y * 0xd8163841u);
+    return (h ^ (h >> 16)) & (GRID_BUCKETS - 1);
+}
+
+static inline i32 cellOf(const SpatialGrid* g, f32 v) {
+    return (i32)floorf(v / g->cellSize);
+}
+
+SpatialGrid* gridCreate(f32 cellSize) {
+    SpatialGrid* g = calloc(1, sizeof(SpatialGrid));
+    if (g == NULL) {
+        perror("Error allocating memory in gridCreate");
+        return NULL;
+    }
+    g->cellSize = cellSize > 0 ? cellSize : GRID_CELL_SIZE;
+    return g;
+}
+
+void gridDestroy(SpatialGrid* g) {
+    if (g == NULL) return;
+
+    for (i32 i = 0; i < GRID_BUCKETS; i++) {
+        free(g->buckets[i].items);
+    }
+    free(g->items);
+    free(g->freeList);
+    free(g->mapKeys);
+    free(g->mapItems);
+    free(g);
+}
+
+static bool growArray(void** arr, i32* cap, usize elem) {
+    i32 next = *cap == 0 ? GRID_START : *cap * 2;
+    void* p = realloc(*arr, elem * next);
+    if (p == NULL) return false;
+    *arr = p;
+    *cap = next;
+    return true;
+}
+
+/*
+ * key map
+ */
+
+static usize mapSlot(const SpatialGrid* g, u64 key) {
+    usize mask = g->mapCap - 1;
+    usize i = hashKey(key) & mask;
+    while (g->mapKeys[i] != 0 && g->mapKeys[i] != key) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+static i32 mapGet(const SpatialGrid* g, u64 key) {
+    if (g->mapCap == 0) return -1;
+    usize i = mapSlot(g, key);
+    return g->mapKeys[i] == key ? g->mapItems[i] : -1;
+}
+
+static bool mapPut(SpatialGrid* g, u64 key, i32 item);
+
+static bool mapGrow(SpatialGrid* g) {
+    u64* oldKeys = g->mapKeys;
+    i32* oldItems = g->mapItems;
+    usize oldCap = g->mapCap;
+
+    usize cap = oldCap == 0 ? GRID_START : oldCap * 2;
+    g->mapKeys = calloc(cap, sizeof(u64));
+    g->mapItems = malloc(sizeof(i32) * cap);
+    if (g->mapKeys == NULL || g->mapItems == NULL) {
+        free(g->mapKeys);
+        free(g->mapItems);
+        g->mapKeys = oldKeys;
+        g->mapItems = oldItems;
+        return false;
+    }
+    g->mapCap = cap;
+    g->mapLen = 0;
+
+    for (usize i = 0; i < oldCap; i++) {
+        if (oldKeys[i] != 0) mapPut(g, oldKeys[i], oldItems[i]);
+    }
+    free(oldKeys);
+    free(oldItems);
+    return true;
+}
+
+static bool mapPut(SpatialGrid* g, u64 key, i32 item) {
+    // keep the load factor under 3/4
+    if ((g->mapLen + 1) * 4 > g->mapCap * 3 && !mapGrow(g)) return false;
+
+    usize i = mapSlot(g, key);
+    if (g->mapKeys[i] == 0) g->mapLen++;
+    g->mapKeys[i] = key;
+    g->mapItems[i] = item;
+    return true;
+}
+
+// backward shift deletion, so lookups never need tombstones
+static void mapDelete(SpatialGrid* g, u64 key) {
+    if (g->mapCap == 0) return;
+
+    usize mask = g->mapCap - 1;
+    usize i = mapSlot(g, key);
+    if (g->mapKeys[i] != key) return;
+
+    usize j = i;
+    while (true) {
+        j = (j + 1) & mask;
+        if (g->mapKeys[j] == 0) break;
+
+        usize home = hashKey(g->mapKeys[j]) & mask;
+        // move j back into the hole at i unless its home lies in (i, j]
+        bool between = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+        if (!between) {
+            g->mapKeys[i] = g->mapKeys[j];
+            g->mapItems[i] = g->mapItems[j];
+            i = j;
+        }
+    }
+    g->mapKeys[i] = 0;
+    g->mapLen--;
+}
+
+/*
+ * buckets
+ */
+
+static void bucketAdd(GridBucket* b, i32 item) {
+    for (i32 i = 0; i < b->len; i++) {
+        if (b->items[i] == item) return; // two cells of one box share a bucket
+    }
+    if (b->len == b->cap && !growArray((void**)&b->items, &b->cap, sizeof(i32))) {
+        perror("Error allocating memory in gridUpdate");
+        return;
+    }
+    b->items[b->len++] = item;
+}
+
+static void bucketRemove(GridBucket* b, i32 item) {
+    for (i32 i = 0; i < b->len; i++) {
+        if (b->items[i] == item) {
+            b->items[i] = b->items[--b->len];
+            return;
+        }
+    }
+}
+
+static void linkCells(SpatialGrid* g, i32 item) {
+    const GridItem* it = &g->items[item];
+    for (i32 y = it->y0; y <= it->y1; y++) {
+        for (i32 x = it->x0; x <= it->x1; x++) {
+            bucketAdd(&g->buckets[cellBucket(x, y)], item);
+        }
+    }
+}
+
+static void unlinkCells(SpatialGrid* g, i32 item) {
+    const GridItem* it = &g->items[item];
+    for (i32 y = it->y0; y <= it->y1; y++) {
+        for (i32 x = it->x0; x <= it->x1; x++) {
+            bucketRemove(&g->buckets[cellBucket(x, y)], item);
+        }
+    }
+}
+
+static i32 allocItem(SpatialGrid* g) {
+    if (g->freeLen > 0) return g->freeList[--g->freeLen];
+
+    if (g->itemLen == g->itemCap) {
+        i32 cap = g->itemCap;
+        if (!growArray((void**)&g->items, &g->itemCap, sizeof(GridItem))) return -1;
+        i32* fl = realloc(g->freeList, sizeof(i32) * g->itemCap);
+        if (fl == NULL) {
+            g->itemCap = cap;
+            return -1;
+        }
+        g->freeList = fl;
+    }
+    return g->itemLen++;
+}
+
+/**
+ * Inserts key with box, or moves it there if it is already in the grid. The
+ * cells are only relinked when the box covers different ones than before.
+ */
+void gridUpdate(SpatialGrid* g, u64 key, Rect box) {
+    i32 x0 = cellOf(g, box.x);
+    i32 y0 = cellOf(g, box.y);
+    i32 x1 = cellOf(g, box.x + box.width);
+    i32 y1 = cellOf(g, box.y + box.height);
+
+    i32 item = mapGet(g, key);
+    if (item >= 0) {
+        GridItem* it = &g->items[item];
+        it->box = box;
+        if (it->x0 == x0 && it->y0 == y0 && it->x1 == x1 && it->y1 == y1) return;
+
+        // unlinking everything is simpler than diffing the two ranges and
+        // costs the same for boxes a few cells wide
+        unlinkCells(g, item);
+    } else {
+        item = allocItem(g);
+        if (item >= 0 && !mapPut(g, key, item)) {
+            g->items[item].key = 0;
+            g->freeList[g->freeLen++] = item;
+            item = -1;
+        }
+        if (item < 0) {
+            perror("Error allocating memory in gridUpdate");
+            return;
+        }
+    }
+
+    g->items[item] = (GridItem){key, box, x0, y0, x1, y1};
+    linkCells(g, item);
+}
+
+void gridRemove(SpatialGrid* g, u64 key) {
+    i32 item = mapGet(g, key);
+    if (item < 0) return;
+
+    unlinkCells(g, item);
+    mapDelete(g, key);
+    g->items[item].key = 0;
+    g->freeList[g->freeLen++] = item;
+}
+
+// writes up to max keys whose box contains p, returns how many were written
+usize gridQueryPoint(const SpatialGrid* g, v2 p, u64* out, usize max) {
+    i32 x = cellOf(g, p.x);
+    i32 y = cellOf(g, p.y);
+    const GridBucket* b = &g->buckets[cellBucket(x, y)];
+    usize n = 0;
+
+    for (i32 i = 0; i < b->len && n < max; i++) {
+        const GridItem* it = &g->items[b->items[i]];
+        const Rect* r = &it->box;
+        if (p.x >= r->x && p.x < r->x + r->width && p.y >= r->y &&
+            p.y < r->y + r->height) {
+            out[n++] = it->key;
+        }
+    }
+    return n;
+}
+
+usize gridCount(const SpatialGrid* g) { return g->mapLen; }
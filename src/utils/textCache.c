@@ -0,0 +1,256 @@
+#include "textCache.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static TextRun** runs = NULL;
+static usize runsLen = 0;
+static usize runsCap = 0;
+static u64 frame = 0;
+
+// baked runs are packed into shelves on a CPU copy of the atlas
+static Image atlasImage;
+static Texture2D atlas;
+static i32 shelfX = 0;
+static i32 shelfY = 0;
+static i32 shelfHeight = 0;
+
+// glyphs are copied out of the font's texture, read back once per font
+static Image fontImage;
+static u32 fontImageId = 0;
+
+static u64 hashText(const char* text) {
+    u64 h = 0xcbf29ce484222325ull;
+    for (const char* c = text; *c; c++) {
+        h = (h ^ (u8)*c) * 0x100000001b3ull;
+    }
+    return h;
+}
+
+// the same layout DrawTextEx does every frame
+static void layoutRun(TextRun* r, Font font) {
+    usize len = strlen(r->text);
+    f32 scale = r->size / font.baseSize;
+    f32 x = 0;
+    f32 y = 0;
+
+    r->quads = malloc(sizeof(GlyphQuad) * MAX(len, 1));
+    r->count = 0;
+    if (r->quads == NULL) {
+        perror("Error allocating memory in layoutRun");
+        return;
+    }
+
+    for (usize i = 0; i < len;) {
+        i32 next = 0;
+        i32 codepoint = GetCodepointNext(&r->text[i], &next);
+        i32 index = GetGlyphIndex(font, codepoint);
+        i += next;
+
+        if (codepoint == '\n') {
+            y += (font.baseSize + TEXT_LINE_SPACING) * scale;
+            x = 0;
+            continue;
+        }
+
+        if (codepoint != ' ' && codepoint != '\t') {
+            const Rect rec = font.recs[index];
+            const GlyphInfo g = font.glyphs[index];
+            const f32 pad = font.glyphPadding;
+
+            r->quads[r->count++] = (GlyphQuad){
+                .src = {rec.x - pad, rec.y - pad, rec.width + 2 * pad,
+                        rec.height + 2 * pad},
+                .dst = {x + (g.offsetX - pad) * scale, y + (g.offsetY - pad) * scale,
+                        (rec.width + 2 * pad) * scale,
+                        (rec.height + 2 * pad) * scale}};
+        }
+
+        if (font.glyphs[index].advanceX == 0) {
+            x += font.recs[index].width * scale + r->spacing;
+        } else {
+            x += font.glyphs[index].advanceX * scale + r->spacing;
+        }
+    }
+
+    r->extent = MeasureTextEx(font, r->text, r->size, r->spacing);
+}
+
+// copies the run's glyphs into the atlas and replaces them with a single quad
+static bool bakeRun(TextRun* r, Font font) {
+    if (!IsWindowReady() || font.texture.id == 0) return false;
+
+    const i32 w = ceilf(r->extent.x);
+    const i32 h = ceilf(r->extent.y);
+    if (w == 0 || h == 0) return false;
+
+    if (shelfX + w > TEXT_ATLAS_SIZE) {
+        shelfX = 0;
+        shelfY += shelfHeight + 1;
+        shelfHeight = 0;
+    }
+    if (w > TEXT_ATLAS_SIZE || shelfY + h > TEXT_ATLAS_SIZE) return false;
+
+    if (atlas.id == 0) {
+        atlasImage = GenImageColor(TEXT_ATLAS_SIZE, TEXT_ATLAS_SIZE, BLANK);
+        atlas = LoadTextureFromImage(atlasImage);
+    }
+    if (fontImageId != font.texture.id) {
+        if (fontImageId != 0) UnloadImage(fontImage);
+        fontImage = LoadImageFromTexture(font.texture);
+        ImageFormat(&fontImage, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+        fontImageId = font.texture.id;
+    }
+
+    const Rect slot = {shelfX, shelfY, w, h};
+
+    // nearest neighbour, to match how the font texture samples on the GPU
+    for (u32 i = 0; i < r->count; i++) {
+        const GlyphQuad q = r->quads[i];
+        Image glyph = ImageFromImage(fontImage, q.src);
+        ImageResizeNN(&glyph, roundf(q.dst.width), roundf(q.dst.height));
+        ImageDraw(&atlasImage, glyph, (Rect){0, 0, glyph.width, glyph.height},
+                  (Rect){slot.x + roundf(q.dst.x), slot.y + roundf(q.dst.y),
+                         glyph.width, glyph.height},
+                  WHITE);
+        UnloadImage(glyph);
+    }
+
+    Image region = ImageFromImage(atlasImage, slot);
+    UpdateTextureRec(atlas, slot, region.data);
+    UnloadImage(region);
+
+    shelfX += w + 1;
+    shelfHeight = MAX(shelfHeight, h);
+
+    r->quads[0] = (GlyphQuad){.src = slot, .dst = {0, 0, w, h}};
+    r->count = 1;
+    r->tex = atlas;
+    r->baked = true;
+    return true;
+}
+
+static void freeRun(TextRun* r) {
+    free(r->quads);
+    free(r->text);
+    free(r);
+}
+
+// the least recently used run that isn't pinned or in use this frame
+static TextRun** evictable(void) {
+    TextRun** oldest = NULL;
+
+    for (usize i = 0; i < runsLen; i++) {
+        TextRun* r = runs[i];
+        if (r->pinned || r->lastFrame == frame) continue;
+        if (oldest == NULL || r->lastFrame < (*oldest)->lastFrame) {
+            oldest = &runs[i];
+        }
+    }
+
+    return oldest;
+}
+
+static TextRun** newSlot(void) {
+    if (runsLen >= TEXT_CACHE_SIZE) {
+        TextRun** slot = evictable();
+        if (slot != NULL) {
+            freeRun(*slot);
+            return slot;
+        }
+    }
+
+    if (runsLen == runsCap) {
+        usize cap = runsCap == 0 ? TEXT_CACHE_SIZE : runsCap * 2;
+        TextRun** r = realloc(runs, sizeof(TextRun*) * cap);
+        if (r == NULL) {
+            perror("Error allocating memory in newSlot");
+            return NULL;
+        }
+        runs = r;
+        runsCap = cap;
+    }
+
+    return &runs[runsLen++];
+}
+
+static const TextRun* lookup(Font font, const char* text, f32 size, f32 spacing,
+                             bool pinned) {
+    const u64 hash = hashText(text);
+
+    for (usize i = 0; i < runsLen; i++) {
+        TextRun* r = runs[i];
+        if (r->hash == hash && r->font == font.texture.id && r->size == size &&
+            r->spacing == spacing && r->pinned == pinned && !strcmp(r->text, text)) {
+            r->lastFrame = frame;
+            return r;
+        }
+    }
+
+    TextRun* r = calloc(1, sizeof(TextRun));
+    if (r == NULL) {
+        perror("Error allocating memory in lookup");
+        return NULL;
+    }
+
+    TextRun** slot = newSlot();
+    if (slot == NULL) {
+        free(r);
+        return NULL;
+    }
+
+    *r = (TextRun){.hash = hash,
+                   .text = strdup(text),
+                   .font = font.texture.id,
+                   .size = size,
+                   .spacing = spacing,
+                   .pinned = pinned,
+                   .tex = font.texture,
+                   .lastFrame = frame};
+    *slot = r;
+    layoutRun(r, font);
+
+    // if there is no room left in the atlas the glyphs are drawn instead
+    if (pinned) bakeRun(r, font);
+
+    return r;
+}
+
+const TextRun* textRun(Font font, const char* text, f32 size, f32 spacing) {
+    return lookup(font, text, size, spacing, false);
+}
+
+const TextRun* textRunBaked(Font font, const char* text, f32 size, f32 spacing) {
+    return lookup(font, text, size, spacing, true);
+}
+
+// draws straight away, for when the render queue isn't involved
+void drawTextRun(const TextRun* run, v2 pos, Color tint) {
+    for (u32 i = 0; i < run->count; i++) {
+        const GlyphQuad* q = &run->quads[i];
+        Rect dst = {pos.x + q->dst.x, pos.y + q->dst.y, q->dst.width, q->dst.height};
+        DrawTexturePro(run->tex, q->src, dst, (v2){0, 0}, 0, tint);
+    }
+}
+
+void textCacheNextFrame(void) { frame++; }
+
+void textCacheClear(void) {
+    for (usize i = 0; i < runsLen; i++) {
+        freeRun(runs[i]);
+    }
+    free(runs);
+    runs = NULL;
+    runsLen = runsCap = 0;
+
+    if (atlas.id != 0) {
+        UnloadTexture(atlas);
+        UnloadImage(atlasImage);
+        atlas = (Texture2D){0};
+    }
+    if (fontImageId != 0) {
+        UnloadImage(fontImage);
+        fontImageId = 0;
+    }
+    shelfX = shelfY = shelfHeight = 0;
+}
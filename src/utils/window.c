@@ -26,13 +26,17 @@ void drawScaledWindow(RenderTexture2D target, f32 sw, f32 sh, f32 scale) {
     DrawTexturePro(target.texture, rect1, rect2, (v2){0, 0}, 0.0f, WHITE);
 }
 
-void setWindowFlags(void) {
-    SetConfigFlags(FLAG_WINDOW_RESIZABLE);
+// a hidden window never waits on vsync or a target fps, for replays that
+// should run as fast as the machine allows. it is still a GL window, so a
+// replay needs a display and a GL driver; on CI, run it under xvfb-run
+void setWindowFlags(bool hidden) {
+    u32 flags = FLAG_WINDOW_RESIZABLE | (WINDOW_VSYNC ? FLAG_VSYNC_HINT : 0);
+    SetConfigFlags(hidden ? FLAG_WINDOW_HIDDEN : flags);
     SetTraceLogLevel(LOG_ALL);
     InitWindow(screenWidth, screenHeight, "Planet Generation Test");
     InitAudioDevice();
     SetMasterVolume(1);
-    SetTargetFPS(60);
+    SetTargetFPS(hidden ? 0 : WINDOW_TARGET_FPS);
     SetWindowSize(screenWidth * 2, screenHeight * 2);
 }
 